@@ -15,13 +15,14 @@ workspace "vkvoxel"
    end
 
    prebuildcommands {
-      { vulkan_sdk .. "/bin/slangc ./shaders/shader.slang -target spirv -profile spirv_1_6 -emit-spirv-directly -fvk-use-entrypoint-name -entry vertMain -entry fragMain -o ./shaders/shader.slang.spv" }
+      { vulkan_sdk .. "/bin/slangc ./shaders/shader.slang -target spirv -profile spirv_1_6 -emit-spirv-directly -fvk-use-entrypoint-name -entry vertMain -entry vertPulled -entry fragMain -o ./shaders/shader.slang.spv" }
    }
 
    includedirs { "src/", "vendor/", vulkan_sdk .. "/include" }
    files { "src/**.hpp", "src/**.cpp" }
    libdirs { vulkan_sdk .. "/lib" }
    links { "SDL3", "volk" }
+   dependson { "texture_baker" }
 
    filter { "configurations:Release" }
       defines { "NDEBUG" }
@@ -41,3 +42,77 @@ workspace "vkvoxel"
       symbols "On"
       end
 
+   filter {}
+
+   -- Bakes the block textures and their mips into resources/textures/blocks.vxtex, which the renderer maps instead of decoding the PNGs
+   project "texture_baker"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++23"
+   architecture "x86_64"
+
+   includedirs { "src/", "vendor/" }
+   files { "tools/texture_baker/**.cpp", "src/renderer/block_textures.hpp", "src/renderer/texture_container.hpp", "src/renderer/texture_container.cpp", "src/world/block.hpp" }
+
+   postbuildcommands {
+      { "%{cfg.buildtarget.abspath}" }
+   }
+
+   filter { "configurations:Release" }
+      defines { "NDEBUG" }
+      symbols "Off"
+      optimize "On"
+
+   filter { "configurations:Debug" }
+      defines { "DEBUG" }
+      warnings "Extra"
+      optimize "Off"
+      symbols "On"
+
+   -- Times generation, lighting and meshing of the world's chunks without SDL or the renderer, one JSON object per line
+   project "world_benchmark"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++23"
+   architecture "x86_64"
+
+   -- Vulkan's headers only, for the vertex layout the mesher's Voxel carries - nothing is linked
+   includedirs { "src/", "vendor/", vulkan_sdk .. "/include" }
+   files { "tools/world_benchmark/**.cpp", "src/world/block.hpp", "src/world/chunk*.hpp", "src/world/chunk*.cpp", "src/world/light_engine.*", "src/renderer/voxel.hpp" }
+
+   filter { "configurations:Release" }
+      defines { "NDEBUG" }
+      symbols "Off"
+      optimize "On"
+
+   filter { "configurations:Debug" }
+      defines { "DEBUG" }
+      warnings "Extra"
+      optimize "Off"
+      symbols "On"
+
+   -- Compares the greedy mesher against a brute-force one face per block face reference, fails the build when they disagree
+   project "chunk_mesher_tests"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++23"
+   architecture "x86_64"
+
+   -- Vulkan's headers only, for the vertex layout the mesher's Voxel carries - nothing is linked
+   includedirs { "src/", "vendor/", vulkan_sdk .. "/include" }
+   files { "tests/chunk_mesher/**.cpp", "src/world/block.hpp", "src/world/chunk.*", "src/world/chunk_map.*", "src/world/chunk_map_block_provider.*", "src/world/chunk_mesher.*", "src/world/chunk_pool.*", "src/renderer/voxel.hpp" }
+
+   postbuildcommands {
+      { "%{cfg.buildtarget.abspath}" }
+   }
+
+   filter { "configurations:Release" }
+      defines { "NDEBUG" }
+      symbols "Off"
+      optimize "On"
+
+   filter { "configurations:Debug" }
+      defines { "DEBUG" }
+      warnings "Extra"
+      optimize "Off"
+      symbols "On"
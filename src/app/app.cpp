@@ -1,37 +1,298 @@
 #include "app/app.hpp"
 
+#include "profiling/cpu_profiler.hpp"
+
 #include <SDL3/SDL_init.h>
+#include <SDL3/SDL_keycode.h>
+#include <SDL3/SDL_mouse.h>
 #include <SDL3/SDL_timer.h>
 #include <SDL3/SDL_video.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <print>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <vector>
 
 constexpr int WIDTH = 1280;
 constexpr int HEIGHT = 720;
+constexpr float BLOCK_REACH = 16.0f;
+constexpr const char *TRACE_FILE = "vkvoxel_trace.json";
+constexpr const char *CAMERA_PATH_FILE = "vkvoxel_camera_path.txt";
+constexpr float REPLAY_TIME_STEP = 1.0f / 60.0f;
+
+constexpr World::GenerationSettings WORLD_SETTINGS =
+{
+    .seed = 12081973,
+    .chunkColumnsX = 32,
+    .chunkColumnsZ = 16,
+    .enableLevelOfDetail = false,
+};
+
+/* Hard caps on chunk block data and chunk geometry. The chunks around the camera are always kept, whatever the budget */
+constexpr World::MemoryBudget WORLD_MEMORY_BUDGET =
+{
+    .chunkBytes = 48ull << 20u,
+    .residentRadius = 10,
+};
+
+constexpr Renderer::Settings RENDERER_SETTINGS =
+{
+    .geometryBudgetBytes = 32ull << 20u,
+    .geometryViewRadius = 10,
+};
+
+/* Restoring geometry meshes the chunk again. Past the resident radius its block data would be reloaded only to be evicted again */
+static_assert(WORLD_MEMORY_BUDGET.residentRadius >= RENDERER_SETTINGS.geometryViewRadius, "restored geometry needs resident block data");
+
+namespace
+{
+    /* Nearest-rank p50, p90 and p99 plus the maximum as a JSON object, null without samples */
+    std::string percentilesJson(std::vector<double> samples)
+    {
+        if (samples.empty())
+        {
+            return "null";
+        }
+
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&](const double fraction)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(samples.size())));
+            return samples.at(std::clamp<size_t>(rank, 1, samples.size()) - 1);
+        };
+
+        return std::format("{{\"p50\":{:.3f},\"p90\":{:.3f},\"p99\":{:.3f},\"max\":{:.3f}}}",
+            percentile(0.5), percentile(0.9), percentile(0.99), samples.back());
+    }
+
+    std::string jsonString(const std::string_view text)
+    {
+        std::string escaped = "\"";
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+
+        return escaped + "\"";
+    }
+}
 
 void App::run(void)
 {
+    CpuProfiler::setThreadName("Main");
+
     createWindow();
 
-    const World::GenerationSettings settings =
-    {
-        .seed = 12081973,
-        .chunkColumnsX = 32,
-        .chunkColumnsZ = 16,
-        .enableLevelOfDetail = false,
-    };
+    m_world.setMemoryBudget(WORLD_MEMORY_BUDGET);
+    m_world.requestChunkGeneration(WORLD_SETTINGS);
 
-    m_world.requestChunkGeneration(settings);
+    m_renderer.init(m_window, RENDERER_SETTINGS);
 
-    m_renderer.init(m_window, m_world);
+    const Renderer::PipelineCacheStats &pipelineCache = m_renderer.pipelineCacheStats();
+    std::println("pipelines created in {:.2f} ms ({})", pipelineCache.pipelineCreationMilliseconds,
+        pipelineCache.loadedFromDisk ? "pipeline cache loaded from disk" : "no usable pipeline cache on disk");
     m_lastTime = SDL_GetTicks();
     mainLoop();
     cleanup();
 }
 
+void App::runHeadless(const uint32_t frameCount, const std::string &outputPath)
+{
+    CpuProfiler::setThreadName("Main");
+
+    m_world.setMemoryBudget(WORLD_MEMORY_BUDGET);
+    m_world.requestChunkGeneration(WORLD_SETTINGS);
+    m_renderer.initHeadless(WIDTH, HEIGHT, RENDERER_SETTINGS);
+
+    /* Nothing streams in while the frames are drawn, so every run renders the same picture */
+    while (m_world.isGenerating())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        const CpuProfiler::Zone frameZone("App frame");
+
+        streamChunkMeshes();
+        m_renderer.updateCamera(m_camera);
+        m_renderer.drawFrame();
+        traceMemoryCounters();
+    }
+
+    if (!outputPath.empty() && frameCount > 0)
+    {
+        m_renderer.saveFrame(outputPath);
+        std::println("wrote {}", outputPath);
+    }
+
+    m_renderer.cleanup();
+}
+
+void App::runReplay(const ReplaySettings &settings)
+{
+    CpuProfiler::setThreadName("Main");
+
+    const CameraPath path = CameraPath::load(settings.cameraPath);
+
+    m_world.setMemoryBudget(WORLD_MEMORY_BUDGET);
+    m_world.requestChunkGeneration(WORLD_SETTINGS);
+
+    /* The periodic GPU log line would land in the middle of the report */
+    Renderer::Settings rendererSettings = RENDERER_SETTINGS;
+    rendererSettings.gpuProfilerLogSeconds = 0.0;
+    if (settings.headless)
+    {
+        m_renderer.initHeadless(WIDTH, HEIGHT, rendererSettings);
+    }
+    else
+    {
+        createWindow();
+        m_renderer.init(m_window, rendererSettings);
+    }
+
+    /* The whole world is in place before the first frame, so the same frames upload the same chunks on every run */
+    while (m_world.isGenerating())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    struct GpuScopeSamples
+    {
+        std::string_view name{};
+        uint64_t seen = 0;
+        std::vector<double> milliseconds{};
+    };
+
+    std::vector<double> cpuFrameMilliseconds;
+    cpuFrameMilliseconds.reserve(settings.frameCount);
+    GpuScopeSamples gpuFrame{ .name = "frame", .seen = m_renderer.gpuProfiler().frameStats().samples };
+    std::vector<GpuScopeSamples> gpuScopes;
+
+    /* Timings only change once a frame's queries are read back, which is a few frames after it was drawn */
+    auto collectGpuSample = [](GpuScopeSamples &samples, const GpuProfiler::ScopeStats &stats)
+    {
+        if (stats.samples > samples.seen)
+        {
+            samples.milliseconds.push_back(stats.lastMilliseconds);
+            samples.seen = stats.samples;
+        }
+    };
+
+    const Renderer::UploadStats uploadsBefore = m_renderer.uploadStats();
+    const auto replayStart = std::chrono::steady_clock::now();
+
+    uint32_t frame = 0;
+    for (bool shouldRun = true; shouldRun && frame < settings.frameCount; frame++)
+    {
+        if (!settings.headless)
+        {
+            SDL_Event event;
+            while (SDL_PollEvent(&event))
+            {
+                if (event.type == SDL_EVENT_QUIT)
+                {
+                    shouldRun = false;
+                }
+
+                if (event.window.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED || event.window.type == SDL_EVENT_WINDOW_MINIMIZED)
+                {
+                    m_renderer.setFramebufferResized(true);
+                }
+            }
+        }
+
+        const CameraPath::Keyframe pose = path.sample(static_cast<float>(frame) * REPLAY_TIME_STEP);
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        {
+            const CpuProfiler::Zone frameZone("App frame");
+
+            m_camera.setPose(pose.position, pose.yaw, pose.pitch);
+            streamChunkMeshes();
+            m_renderer.updateCamera(m_camera);
+            m_renderer.drawFrame();
+        }
+
+        traceMemoryCounters();
+
+        cpuFrameMilliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+        const GpuProfiler &gpuProfiler = m_renderer.gpuProfiler();
+        collectGpuSample(gpuFrame, gpuProfiler.frameStats());
+        for (const GpuProfiler::ScopeStats &stats : gpuProfiler.scopeStats())
+        {
+            auto scope = std::find_if(gpuScopes.begin(), gpuScopes.end(), [&](const GpuScopeSamples &entry) { return entry.name == stats.name; });
+            if (scope == gpuScopes.end())
+            {
+                gpuScopes.push_back(GpuScopeSamples{ .name = stats.name });
+                scope = std::prev(gpuScopes.end());
+            }
+
+            collectGpuSample(*scope, stats);
+        }
+    }
+
+    m_renderer.waitIdle();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+    const Renderer::UploadStats &uploadsAfter = m_renderer.uploadStats();
+
+    const World::MemoryStats worldMemory = m_world.memoryStats();
+    const Renderer::MemoryStats gpuMemory = m_renderer.memoryStats();
+
+    std::string scopes;
+    for (const GpuScopeSamples &scope : gpuScopes)
+    {
+        scopes += std::format("{}{}:{}", scopes.empty() ? "" : ",", jsonString(scope.name), percentilesJson(scope.milliseconds));
+    }
+
+    const std::string report = std::format(
+        "{{\"cameraPath\":{},\"seed\":{},\"headless\":{},\"frames\":{},\"timeStep\":{:.6f},\"seconds\":{:.3f},"
+        "\"cpuFrameMs\":{},\"gpuFrameMs\":{},\"gpuScopeMs\":{{{}}},\"uploadBytes\":{},\"chunksBuilt\":{},"
+        "\"peakChunkBytes\":{},\"peakMeshBytes\":{},\"peakGpuBytes\":{}}}",
+        jsonString(settings.cameraPath), WORLD_SETTINGS.seed, settings.headless, frame, REPLAY_TIME_STEP, seconds,
+        percentilesJson(cpuFrameMilliseconds), percentilesJson(gpuFrame.milliseconds), scopes,
+        uploadsAfter.bytes - uploadsBefore.bytes, uploadsAfter.chunkMeshes - uploadsBefore.chunkMeshes,
+        worldMemory.peakChunkBytes, worldMemory.peakMeshBytes, gpuMemory.peakAllocatedBytes);
+
+    std::println("{}", report);
+
+    if (!settings.reportPath.empty())
+    {
+        std::ofstream file(settings.reportPath, std::ios::trunc);
+        file << report << '\n';
+        if (!file)
+        {
+            throw std::runtime_error("App::runReplay(): failed to write " + settings.reportPath);
+        }
+    }
+
+    if (settings.headless)
+    {
+        m_renderer.cleanup();
+    }
+    else
+    {
+        cleanup();
+    }
+}
+
 void App::createWindow(void)
 {
     /* Initialize SDL's video subsystem - we need this for working with windows */
@@ -68,42 +329,201 @@ void App::mainLoop(void)
 
     while (shouldRun)
     {
+        const CpuProfiler::Zone frameZone("App frame");
+
         const uint64_t currentTime = SDL_GetTicks();
         const float deltaTime = static_cast<float>(currentTime - m_lastTime) / 1000.0f;
         m_lastTime = currentTime;
 
         /* Handle events */
-        while (SDL_PollEvent(&event))
         {
-            /* Exit the application if the user requested it, e.g. when the 'X' on the title bar is clicked, or Alt+F4 is pressed */
-            if (event.type == SDL_EVENT_QUIT)
+            const CpuProfiler::Zone eventZone("SDL_PollEvent");
+            while (SDL_PollEvent(&event))
             {
-                shouldRun = false;
-                break;
-            }
+                /* Exit the application if the user requested it, e.g. when the 'X' on the title bar is clicked, or Alt+F4 is pressed */
+                if (event.type == SDL_EVENT_QUIT)
+                {
+                    shouldRun = false;
+                    break;
+                }
 
-            /* Recreate the swap chain if the window is resized or minimized */
-            if (event.window.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED || event.window.type == SDL_EVENT_WINDOW_MINIMIZED)
-            {
-                m_renderer.setFramebufferResized(true);
-            }
+                /* Recreate the swap chain if the window is resized or minimized */
+                if (event.window.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED || event.window.type == SDL_EVENT_WINDOW_MINIMIZED)
+                {
+                    m_renderer.setFramebufferResized(true);
+                }
 
-            m_camera.processEvent(event, m_window);
-        }
+                /* Left click breaks the targeted block, right click places one against the targeted face */
+                if (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN && SDL_GetWindowRelativeMouseMode(m_window))
+                {
+                    editTargetBlock(event.button.button);
+                }
+
+                /* The number keys pick which block gets placed */
+                if (event.type == SDL_EVENT_KEY_DOWN && event.key.key >= SDLK_1 && event.key.key < SDLK_1 + BLOCK_TYPE_COUNT - 1)
+                {
+                    m_placeBlock = static_cast<BlockType>(event.key.key - SDLK_1 + 1);
+                }
 
-        /* Update camera and uniform state */
-        m_camera.update(deltaTime);
+                /* F9 dumps the recent CPU zones of every thread, open the file in Perfetto or chrome://tracing. F12 is left to RenderDoc */
+                if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_F9)
+                {
+                    if (CpuProfiler::writeChromeTrace(TRACE_FILE))
+                    {
+                        std::println("wrote {}", TRACE_FILE);
+                    }
+                    else
+                    {
+                        std::println("failed to write {}", TRACE_FILE);
+                    }
+                }
 
-        World::Mesh generatedMesh;
-        if (m_world.consumeGeneratedMesh(generatedMesh))
+                /* F8 starts recording the camera's flight and saves it once pressed again, see runReplay() */
+                if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_F8 && !event.key.repeat)
+                {
+                    m_recordingPath = !m_recordingPath;
+                    if (m_recordingPath)
+                    {
+                        m_recordedPath.clear();
+                        m_recordingTime = 0.0f;
+                        std::println("recording the camera path");
+                    }
+                    else if (!m_recordedPath.empty())
+                    {
+                        m_recordedPath.save(CAMERA_PATH_FILE);
+                        std::println("wrote {} ({:.1f} s)", CAMERA_PATH_FILE, m_recordedPath.duration());
+                    }
+                }
+
+                m_camera.processEvent(event, m_window);
+            }
+        }
+
+        /* Update the camera */
         {
-            m_renderer.updateWorldMesh(std::move(generatedMesh));
+            const CpuProfiler::Zone cameraZone("Camera::update");
+            m_camera.update(deltaTime, m_world);
         }
 
-        m_renderer.updateUniformBuffer(m_camera);
+        recordCameraPath(deltaTime);
+
+        streamChunkMeshes();
+
+        m_renderer.updateCamera(m_camera);
         
         /* Render frame */
         m_renderer.drawFrame();
+
+        traceMemoryCounters();
+    }
+}
+
+void App::recordCameraPath(const float deltaTime)
+{
+    if (!m_recordingPath)
+    {
+        return;
+    }
+
+    /* The first pose is at 0 s, every later one a frame's worth of time after the previous */
+    if (!m_recordedPath.empty())
+    {
+        m_recordingTime += deltaTime;
+    }
+
+    m_recordedPath.append(CameraPath::Keyframe{
+        .time = m_recordingTime,
+        .position = m_camera.position(),
+        .yaw = m_camera.yaw(),
+        .pitch = m_camera.pitch(),
+    });
+}
+
+void App::streamChunkMeshes(void)
+{
+    /* Keep both budgets, chunks whose geometry was dropped and that are back in view get meshed again */
+    m_world.updateResidency(m_camera.position());
+
+    std::vector<ChunkCoord> restore;
+    m_renderer.updateGeometryResidency(restore);
+    if (!restore.empty())
+    {
+        m_world.requestMeshes(restore);
+    }
+
+    /* Queue edited chunks for re-meshing, then swap in whatever the workers have finished */
+    m_world.flushDirtyChunks();
+
+    std::vector<World::Mesh> chunkMeshes;
+    if (m_world.consumeChunkMeshes(chunkMeshes))
+    {
+        for (World::Mesh &mesh : chunkMeshes)
+        {
+            m_renderer.updateChunkMesh(std::move(mesh));
+        }
+    }
+}
+
+void App::traceMemoryCounters(void)
+{
+    if (!CpuProfiler::enabled())
+    {
+        return;
+    }
+
+    const World::MemoryStats world = m_world.memoryStats();
+    CpuProfiler::counter("Memory: chunks", static_cast<int64_t>(world.chunkBytes));
+    CpuProfiler::counter("Memory: CPU meshes", static_cast<int64_t>(world.meshBytes));
+
+    const Renderer::MemoryStats gpu = m_renderer.memoryStats();
+    VkDeviceSize bufferBytes = 0;
+    VkDeviceSize imageBytes = 0;
+    for (const Renderer::MemoryStats::MemoryType &type : gpu.types)
+    {
+        bufferBytes += type.bufferBytes;
+        imageBytes += type.imageBytes;
+    }
+
+    CpuProfiler::counter("Memory: GPU buffers", static_cast<int64_t>(bufferBytes));
+    CpuProfiler::counter("Memory: GPU images", static_cast<int64_t>(imageBytes));
+
+    if (!gpu.budgetAvailable)
+    {
+        return;
+    }
+
+    /* The heaps that matter for streaming, system memory heaps are shared with everything else on the machine */
+    VkDeviceSize deviceLocalUsage = 0;
+    VkDeviceSize deviceLocalBudget = 0;
+    for (const Renderer::MemoryStats::MemoryHeap &heap : gpu.heaps)
+    {
+        if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0)
+        {
+            deviceLocalUsage += heap.usage;
+            deviceLocalBudget += heap.budget;
+        }
+    }
+
+    CpuProfiler::counter("Memory: GPU device local usage", static_cast<int64_t>(deviceLocalUsage));
+    CpuProfiler::counter("Memory: GPU device local budget", static_cast<int64_t>(deviceLocalBudget));
+}
+
+void App::editTargetBlock(const uint8_t button)
+{
+    const std::optional<World::RaycastHit> hit = m_world.raycast(m_camera.position(), m_camera.front(), BLOCK_REACH);
+    if (!hit.has_value())
+    {
+        return;
+    }
+
+    if (button == SDL_BUTTON_LEFT)
+    {
+        m_world.setBlock(hit->block.x, hit->block.y, hit->block.z, BlockType::Air);
+    }
+    else if (button == SDL_BUTTON_RIGHT && hit->normal != glm::ivec3{ 0 })
+    {
+        const glm::ivec3 target = hit->block + hit->normal;
+        m_world.setBlock(target.x, target.y, target.z, m_placeBlock);
     }
 }
 
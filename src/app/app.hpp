@@ -2,23 +2,54 @@
 
 #include <SDL3/SDL_video.h>
 
+#include <cstdint>
+#include <string>
+
 #include "camera/camera.hpp"
+#include "camera/camera_path.hpp"
 #include "renderer/renderer.hpp"
 #include "world/world.hpp"
 
 class App
 {
 public:
+    struct ReplaySettings
+    {
+        std::string cameraPath{};
+        uint32_t frameCount = 0;
+        bool headless = false;
+        std::string reportPath{}; /* Where the JSON report is saved as well, empty to only print it */
+    };
+
     void run(void);
 
+    /* Draws frameCount frames of the freshly generated world without a window, then saves the last one if outputPath isn't empty */
+    void runHeadless(const uint32_t frameCount, const std::string &outputPath);
+
+    /* Flies the camera along a CameraPath file over the world of the fixed seed, a fixed 1/60 s per frame whatever the frame rate,
+       and prints a JSON report of CPU and GPU frame time percentiles, upload bytes and chunks built. No input is read */
+    void runReplay(const ReplaySettings &settings);
+
 private:
     void createWindow(void);
     void mainLoop(void);
+    void recordCameraPath(const float deltaTime);
+    void streamChunkMeshes(void);
+
+    /* Samples World::memoryStats() and Renderer::memoryStats() into counter tracks of the CPU trace */
+    void traceMemoryCounters(void);
+    void editTargetBlock(const uint8_t button);
     void cleanup(void);
 
     SDL_Window *m_window{ NULL };
     Renderer m_renderer{};
     Camera m_camera{};
     World m_world{};
+    BlockType m_placeBlock{ BlockType::Stone };
     uint64_t m_lastTime{ 0 };
+
+    /* F8 starts and stops recording the camera into a path file for runReplay() */
+    bool m_recordingPath{ false };
+    float m_recordingTime{ 0.0f };
+    CameraPath m_recordedPath{};
 };
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <stdexcept>
 
 #include <SDL3/SDL_mouse.h>
@@ -42,6 +43,10 @@ void Camera::processEvent(const SDL_Event &event, SDL_Window *window)
                 m_moveDown = true;
                 break;
             
+            case SDLK_N:
+                m_collisionsEnabled = !m_collisionsEnabled;
+                break;
+            
             case SDLK_ESCAPE:
                 if (SDL_GetWindowRelativeMouseMode(window))
                 {
@@ -104,7 +109,7 @@ void Camera::processEvent(const SDL_Event &event, SDL_Window *window)
     }
 }
 
-void Camera::update(const float deltaTime)
+void Camera::update(const float deltaTime, const World &world)
 {
     const float velocity = m_speed * deltaTime;
 
@@ -116,50 +121,120 @@ void Camera::update(const float deltaTime)
 
     const glm::vec3 right = glm::normalize(glm::cross(front, m_up));
 
+    glm::vec3 motion { 0.0f };
+
     if (m_moveForward)
     {
-        m_position += front * velocity;
+        motion += front * velocity;
     }
     
     if (m_moveBackward)
     {
-        m_position -= front * velocity;
+        motion -= front * velocity;
     }
     
     if (m_moveLeft)
     {
-        m_position -= right * velocity;
+        motion -= right * velocity;
     }
     
     if (m_moveRight)
     {
-        m_position += right * velocity;
+        motion += right * velocity;
     }
     
     if (m_moveUp)
     {
-        m_position += m_up * velocity;
+        motion += m_up * velocity;
     }
     
     if (m_moveDown)
     {
-        m_position -= m_up * velocity; 
+        motion -= m_up * velocity; 
+    }
+
+    /* If we're already stuck inside terrain (e.g. after toggling collisions back on) let the camera fly out freely */
+    if (m_collisionsEnabled && !world.intersectsSolid(bounds()))
+    {
+        motion = world.sweepAabb(bounds(), motion).motion;
     }
 
+    m_position += motion;
     m_front = front;
 }
 
+void Camera::setPose(const glm::vec3 &position, const float yaw, const float pitch)
+{
+    m_position = position;
+    m_yaw = yaw;
+    m_pitch = glm::clamp(pitch, -89.0f, 89.0f);
+
+    m_front = glm::normalize(glm::vec3(
+        glm::cos(glm::radians(m_pitch)) * glm::cos(glm::radians(m_yaw)),
+        glm::sin(glm::radians(m_pitch)),
+        glm::cos(glm::radians(m_pitch)) * glm::sin(glm::radians(m_yaw))
+    ));
+}
+
+const glm::vec3 &Camera::position(void) const
+{
+    return m_position;
+}
+
+const glm::vec3 &Camera::front(void) const
+{
+    return m_front;
+}
+
+float Camera::yaw(void) const
+{
+    return m_yaw;
+}
+
+float Camera::pitch(void) const
+{
+    return m_pitch;
+}
+
+World::Aabb Camera::bounds(void) const
+{
+    return World::Aabb{
+        .min = m_position - m_extentBelowEye,
+        .max = m_position + m_extentAboveEye,
+    };
+}
+
 glm::mat4 Camera::viewMatrix(void) const
 {
     return glm::lookAt(m_position, m_position + m_front, m_up);
 }
 
+glm::mat4 Camera::viewRotationMatrix(void) const
+{
+    return glm::lookAt(glm::vec3{ 0.0f }, m_front, m_up);
+}
+
 glm::mat4 Camera::projectionMatrix(const float aspectRatio) const
 {
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 1500.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(FIELD_OF_VIEW), aspectRatio, NEAR_PLANE, FAR_PLANE);
     
     /* GLM is originally for OpenGL, so for everything to not be upside down in Vulkan we must reverse the projection matrix */
     projection[1][1] *= -1;
     
     return projection;
 }
+
+glm::mat4 Camera::reverseInfiniteProjectionMatrix(const float aspectRatio) const
+{
+    const float focalLength = 1.0f / std::tan(glm::radians(FIELD_OF_VIEW) * 0.5f);
+
+    /* Clip z is the near plane distance and clip w the view depth, so depth = near / distance never reaches 0 and
+       the far plane is gone. Floating point depth is most precise near 0, which is where the distant terrain ends up */
+    glm::mat4 projection{ 0.0f };
+    projection[0][0] = focalLength / aspectRatio;
+    projection[1][1] = -focalLength; /* Flipped for Vulkan, like above */
+    projection[2][3] = -1.0f;
+    projection[3][2] = NEAR_PLANE;
+
+    return projection;
+}
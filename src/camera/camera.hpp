@@ -4,18 +4,39 @@
 #include <SDL3/SDL_video.h>
 #include <glm/glm.hpp>
 
+#include "world/world.hpp"
+
 class Camera
 {
 public:
     Camera() = default;
 
     void processEvent(const SDL_Event &event, SDL_Window *window);
-    void update(const float deltaTime);
+    void update(const float deltaTime, const World &world);
+
+    /* Places the camera directly, e.g. when replaying a CameraPath. Collisions aren't checked */
+    void setPose(const glm::vec3 &position, const float yaw, const float pitch);
+
+    const glm::vec3 &position(void) const;
+    const glm::vec3 &front(void) const;
+    float yaw(void) const;
+    float pitch(void) const;
+    World::Aabb bounds(void) const;
 
     glm::mat4 viewMatrix(void) const;
+
+    /* View matrix for positions that are already relative to the camera, i.e. without the translation */
+    glm::mat4 viewRotationMatrix(void) const;
     glm::mat4 projectionMatrix(const float aspectRatio) const;
 
+    /* Reverse-Z projection with the far plane at infinity: depth is 1 at the near plane and falls towards 0 with distance */
+    glm::mat4 reverseInfiniteProjectionMatrix(const float aspectRatio) const;
+
 private:
+    static constexpr float FIELD_OF_VIEW = 45.0f;
+    static constexpr float NEAR_PLANE = 0.1f;
+    static constexpr float FAR_PLANE = 1500.0f;
+
     glm::vec3 m_position { 0.0f, 44.0f, -96.0f };
     glm::vec3 m_front { 0.0f, -0.24f, 0.97f };
     glm::vec3 m_up { 0.0f, 1.0f, 0.0f };
@@ -26,6 +47,11 @@ private:
     float m_speed = 32.0f;
     float m_mouseSensitivity = 0.1f;
 
+    /* Collision box around the eye, roughly player sized */
+    glm::vec3 m_extentBelowEye { 0.3f, 1.5f, 0.3f };
+    glm::vec3 m_extentAboveEye { 0.3f, 0.3f, 0.3f };
+    bool m_collisionsEnabled = true;
+
     bool m_moveForward = false;
     bool m_moveBackward = false;
     bool m_moveLeft = false;
@@ -0,0 +1,125 @@
+#include "camera/camera_path.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+CameraPath CameraPath::load(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("CameraPath::load(): failed to open " + path);
+    }
+
+    CameraPath cameraPath;
+    std::string line;
+    for (uint32_t lineNumber = 1; std::getline(file, line); lineNumber++)
+    {
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        Keyframe keyframe{};
+        std::string trailing;
+        if (!(fields >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch) || (fields >> trailing))
+        {
+            throw std::runtime_error(std::format("CameraPath::load(): {}:{} isn't \"<seconds> <x> <y> <z> <yaw> <pitch>\"", path, lineNumber));
+        }
+
+        if (!cameraPath.empty() && keyframe.time < cameraPath.duration())
+        {
+            throw std::runtime_error(std::format("CameraPath::load(): {}:{} goes back in time", path, lineNumber));
+        }
+
+        cameraPath.append(keyframe);
+    }
+
+    if (cameraPath.empty())
+    {
+        throw std::runtime_error("CameraPath::load(): " + path + " has no keyframes");
+    }
+
+    return cameraPath;
+}
+
+void CameraPath::save(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("CameraPath::save(): failed to open " + path);
+    }
+
+    file << "# seconds x y z yaw pitch\n";
+    for (const Keyframe &keyframe : m_keyframes)
+    {
+        file << std::format("{:.4f} {:.3f} {:.3f} {:.3f} {:.3f} {:.3f}\n",
+            keyframe.time, keyframe.position.x, keyframe.position.y, keyframe.position.z, keyframe.yaw, keyframe.pitch);
+    }
+
+    if (!file)
+    {
+        throw std::runtime_error("CameraPath::save(): failed to write " + path);
+    }
+}
+
+void CameraPath::append(const Keyframe &keyframe)
+{
+    m_keyframes.push_back(keyframe);
+}
+
+void CameraPath::clear(void)
+{
+    m_keyframes.clear();
+}
+
+bool CameraPath::empty(void) const
+{
+    return m_keyframes.empty();
+}
+
+float CameraPath::duration(void) const
+{
+    return m_keyframes.empty() ? 0.0f : m_keyframes.back().time;
+}
+
+CameraPath::Keyframe CameraPath::sample(const float time) const
+{
+    if (m_keyframes.empty())
+    {
+        return Keyframe{};
+    }
+
+    if (time <= m_keyframes.front().time)
+    {
+        return m_keyframes.front();
+    }
+
+    if (time >= m_keyframes.back().time)
+    {
+        return m_keyframes.back();
+    }
+
+    /* First keyframe after time, so next - 1 is at or before it */
+    const auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), time, [](const float value, const Keyframe &keyframe) { return value < keyframe.time; });
+    const Keyframe &from = *std::prev(next);
+    const Keyframe &to = *next;
+
+    const float span = to.time - from.time;
+    const float t = span > 0.0f ? (time - from.time) / span : 1.0f;
+
+    return Keyframe{
+        .time = time,
+        .position = glm::mix(from.position, to.position, t),
+        .yaw = glm::mix(from.yaw, to.yaw, t),
+        .pitch = glm::mix(from.pitch, to.pitch, t),
+    };
+}
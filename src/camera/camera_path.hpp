@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/* A camera flight as keyframes, linearly interpolated in between. Stored as text, one keyframe per line:
+   "<seconds> <x> <y> <z> <yaw> <pitch>", blank lines and lines starting with '#' are skipped. Paths can be written by hand or
+   recorded from the running app, and are replayed at a fixed time step so every run sees exactly the same frames */
+class CameraPath
+{
+public:
+    struct Keyframe
+    {
+        float time = 0.0f;
+        glm::vec3 position{ 0.0f };
+        float yaw = 0.0f;
+        float pitch = 0.0f;
+    };
+
+    /* Throws if the file can't be read, a line doesn't parse or the times go backwards */
+    [[nodiscard]] static CameraPath load(const std::string &path);
+    void save(const std::string &path) const;
+
+    /* Keyframes have to be appended in time order */
+    void append(const Keyframe &keyframe);
+    void clear(void);
+
+    [[nodiscard]] bool empty(void) const;
+    [[nodiscard]] float duration(void) const;
+
+    /* Clamped to the first and the last keyframe outside of the path */
+    [[nodiscard]] Keyframe sample(const float time) const;
+
+private:
+    std::vector<Keyframe> m_keyframes{};
+};
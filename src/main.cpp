@@ -3,12 +3,56 @@
 #include <cstdlib>
 #include <exception>
 #include <print>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
-int main(void)
+int main(int argc, char **argv)
 {
+	const std::string_view mode = argc >= 2 ? std::string_view(argv[1]) : std::string_view();
+
+	/* Both modes read their arguments unchecked below, so a missing frame count is a usage error rather than a windowed run */
+	if ((mode == "--headless" && argc < 3) || (mode == "--replay" && argc < 4))
+	{
+		std::println("usage: vkvoxel [--headless <frames> [output.png]] [--replay <camera path> <frames> [--headless] [--report report.json]]");
+		return EXIT_FAILURE;
+	}
+
 	try {
 		App app;
-		app.run();
+
+		/* vkvoxel --headless <frames> [output.png] renders without a window, e.g. in CI or on lavapipe */
+		if (mode == "--headless")
+		{
+			app.runHeadless(static_cast<uint32_t>(std::stoul(argv[2])), argc >= 4 ? argv[3] : "");
+		}
+		/* vkvoxel --replay <camera path> <frames> [--headless] [--report report.json] flies a recorded or scripted path */
+		else if (mode == "--replay")
+		{
+			App::ReplaySettings settings{ .cameraPath = argv[2], .frameCount = static_cast<uint32_t>(std::stoul(argv[3])) };
+			for (int i = 4; i < argc; i++)
+			{
+				const std::string_view option(argv[i]);
+				if (option == "--headless")
+				{
+					settings.headless = true;
+				}
+				else if (option == "--report" && i + 1 < argc)
+				{
+					settings.reportPath = argv[++i];
+				}
+				else
+				{
+					throw std::runtime_error("unknown replay option " + std::string(option));
+				}
+			}
+
+			app.runReplay(settings);
+		}
+		else
+		{
+			app.run();
+		}
 	}
 	catch (const std::exception &e)
 	{
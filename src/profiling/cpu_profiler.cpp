@@ -0,0 +1,231 @@
+#include "profiling/cpu_profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+std::atomic_bool CpuProfiler::s_enabled{ true };
+
+namespace
+{
+    struct Event
+    {
+        std::atomic<const char *> name{ nullptr };
+        std::atomic<int64_t> start{ 0 };
+        std::atomic<int64_t> duration{ 0 }; /* The sampled value for counters */
+        std::atomic_bool counter{ false };
+    };
+
+    /* Written by its own thread only, like a seqlock: a slot is reserved before it is overwritten and committed after.
+       The trace writer copies up to committed and then looks at reserved, so it can tell which of the slots it copied
+       may have been overwritten in the meantime */
+    struct ThreadBuffer
+    {
+        uint32_t threadId = 0;
+        std::atomic<const char *> name{ nullptr };
+        std::atomic<uint64_t> reserved{ 0 };
+        std::atomic<uint64_t> committed{ 0 };
+        std::array<Event, CpuProfiler::EVENTS_PER_THREAD> events{};
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers{};
+    };
+
+    [[nodiscard]] Registry &registry(void)
+    {
+        static Registry instance{};
+        return instance;
+    }
+
+    /* Registered on the thread's first zone. The registry shares ownership, so the zones of a worker that has
+       since exited still end up in the trace */
+    [[nodiscard]] ThreadBuffer &threadBuffer(void)
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = []()
+        {
+            auto created = std::make_shared<ThreadBuffer>();
+
+            Registry &instance = registry();
+            std::lock_guard lock(instance.mutex);
+            created->threadId = static_cast<uint32_t>(instance.buffers.size() + 1);
+            instance.buffers.push_back(created);
+            return created;
+        }();
+
+        return *buffer;
+    }
+
+    void record(const char *name, const int64_t start, const int64_t duration, const bool counter)
+    {
+        ThreadBuffer &buffer = threadBuffer();
+        const uint64_t index = buffer.committed.load(std::memory_order_relaxed);
+        Event &event = buffer.events[index % CpuProfiler::EVENTS_PER_THREAD];
+
+        buffer.reserved.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        event.name.store(name, std::memory_order_relaxed);
+        event.start.store(start, std::memory_order_relaxed);
+        event.duration.store(duration, std::memory_order_relaxed);
+        event.counter.store(counter, std::memory_order_relaxed);
+        buffer.committed.store(index + 1, std::memory_order_release);
+    }
+
+    void writeJsonString(std::ofstream &file, const std::string_view text)
+    {
+        file << '"';
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                file << '\\';
+            }
+
+            file << c;
+        }
+        file << '"';
+    }
+
+    const auto CLOCK_EPOCH = std::chrono::steady_clock::now();
+}
+
+CpuProfiler::Zone::Zone(const char *name) : m_name(name)
+{
+    if (s_enabled.load(std::memory_order_relaxed))
+    {
+        m_start = now();
+    }
+}
+
+CpuProfiler::Zone::~Zone()
+{
+    if (m_start < 0)
+    {
+        return;
+    }
+
+    record(m_name, m_start, now() - m_start, false);
+}
+
+void CpuProfiler::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::enabled(void)
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void CpuProfiler::setThreadName(const char *name)
+{
+    threadBuffer().name.store(name, std::memory_order_relaxed);
+}
+
+void CpuProfiler::counter(const char *name, const int64_t value)
+{
+    if (s_enabled.load(std::memory_order_relaxed))
+    {
+        record(name, now(), value, true);
+    }
+}
+
+int64_t CpuProfiler::now(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - CLOCK_EPOCH).count();
+}
+
+bool CpuProfiler::writeChromeTrace(const std::filesystem::path &path)
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        Registry &instance = registry();
+        std::lock_guard lock(instance.mutex);
+        buffers = instance.buffers;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    struct CopiedEvent
+    {
+        const char *name = nullptr;
+        int64_t start = 0;
+        int64_t duration = 0;
+        bool counter = false;
+    };
+
+    std::vector<CopiedEvent> copied;
+    copied.reserve(EVENTS_PER_THREAD);
+
+    for (const std::shared_ptr<ThreadBuffer> &buffer : buffers)
+    {
+        const char *threadName = buffer->name.load(std::memory_order_relaxed);
+        if (threadName != nullptr)
+        {
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+            writeJsonString(file, threadName);
+            file << "}}";
+            first = false;
+        }
+
+        const uint64_t head = buffer->committed.load(std::memory_order_acquire);
+        const uint64_t begin = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+
+        copied.clear();
+        for (uint64_t index = begin; index < head; index++)
+        {
+            const Event &event = buffer->events[index % EVENTS_PER_THREAD];
+            copied.push_back(CopiedEvent{
+                .name = event.name.load(std::memory_order_relaxed),
+                .start = event.start.load(std::memory_order_relaxed),
+                .duration = event.duration.load(std::memory_order_relaxed),
+                .counter = event.counter.load(std::memory_order_relaxed),
+            });
+        }
+
+        /* Everything the thread started writing while we were copying may have replaced one of the oldest slots */
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t reserved = buffer->reserved.load(std::memory_order_relaxed);
+        const uint64_t firstIntact = reserved > EVENTS_PER_THREAD ? reserved - EVENTS_PER_THREAD : 0;
+
+        for (uint64_t index = std::max(begin, firstIntact); index < head; index++)
+        {
+            const CopiedEvent &event = copied[index - begin];
+
+            /* Trace timestamps are in microseconds */
+            file << (first ? "" : ",") << "\n{\"name\":";
+            writeJsonString(file, event.name != nullptr ? event.name : "?");
+            file << ",\"ph\":\"" << (event.counter ? 'C' : 'X') << "\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << static_cast<double>(event.start) / 1000.0;
+
+            if (event.counter)
+            {
+                file << ",\"args\":{\"value\":" << event.duration << "}}";
+            }
+            else
+            {
+                file << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0 << "}";
+            }
+            first = false;
+        }
+    }
+
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+/* Scoped CPU zones for the main loop, the renderer and the world's worker threads. Every thread records into a ring
+   buffer of its own, so a zone costs two clock reads and a few relaxed stores - no locks and no allocation. The most
+   recent zones of every thread can be written out as Chrome trace JSON, which chrome://tracing and Perfetto open */
+class CpuProfiler
+{
+public:
+    /* Zones per thread that survive until the next trace is written, older ones are overwritten */
+    static constexpr uint32_t EVENTS_PER_THREAD = 1u << 16u;
+
+    /* Times the rest of the enclosing block. The name must outlive the profiler, string literals are the intended use */
+    class Zone
+    {
+    public:
+        explicit Zone(const char *name);
+        ~Zone();
+
+        Zone(const Zone &) = delete;
+        Zone &operator=(const Zone &) = delete;
+        Zone(Zone &&) = delete;
+        Zone &operator=(Zone &&) = delete;
+
+    private:
+        const char *m_name = nullptr;
+        int64_t m_start = -1; /* -1 while profiling is off */
+    };
+
+    /* Profiling starts enabled; a disabled profiler records nothing but still keeps what it already has */
+    static void setEnabled(bool enabled);
+    [[nodiscard]] static bool enabled(void);
+
+    /* Shown as the thread's track name in the trace. Same lifetime rules as zone names */
+    static void setThreadName(const char *name);
+
+    /* Samples a value that changes over time, such as bytes in use, into a counter track of the trace. Same lifetime rules as zone names */
+    static void counter(const char *name, int64_t value);
+
+    /* Safe to call while other threads keep recording, zones that get overwritten during the copy are left out.
+       Returns false if the file couldn't be written */
+    static bool writeChromeTrace(const std::filesystem::path &path);
+
+    /* Nanoseconds on the clock every zone is measured with */
+    [[nodiscard]] static int64_t now(void);
+
+private:
+    static std::atomic_bool s_enabled;
+};
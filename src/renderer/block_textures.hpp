@@ -0,0 +1,18 @@
+#pragma once
+
+#include "world/block.hpp"
+
+#include <array>
+
+/* Source images of the block texture array, indexed by BlockTexture */
+static constexpr std::array<const char *, BLOCK_TEXTURE_COUNT> BLOCK_TEXTURE_FILES = {
+    "resources/textures/dirt.png",
+    "resources/textures/grass_side.png",
+    "resources/textures/grass_top.png",
+    "resources/textures/sand.png",
+    "resources/textures/stone.png",
+    "resources/textures/lamp.png",
+};
+
+/* The same layers with their whole mip chain, written by texture_baker */
+static constexpr const char *BAKED_BLOCK_TEXTURES_FILE = "resources/textures/blocks.vxtex";
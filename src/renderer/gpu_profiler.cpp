@@ -0,0 +1,239 @@
+#include "renderer/gpu_profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <print>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    /* Queries 0 and 1 bracket the whole frame, scope i uses 2 + 2i and 3 + 2i */
+    constexpr uint32_t FRAME_QUERIES = 2;
+    constexpr uint32_t QUERY_COUNT = FRAME_QUERIES + GpuProfiler::MAX_SCOPES * 2;
+
+    constexpr double AVERAGE_WEIGHT = 1.0 / 32.0;
+}
+
+GpuProfiler::Scope::Scope(GpuProfiler &profiler, VkCommandBuffer cmdBuffer, const char *name)
+    : m_profiler(profiler), m_cmdBuffer(cmdBuffer), m_scope(profiler.beginScope(cmdBuffer, name))
+{
+}
+
+GpuProfiler::Scope::~Scope()
+{
+    m_profiler.endScope(m_cmdBuffer, m_scope);
+}
+
+void GpuProfiler::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, double logIntervalSeconds)
+{
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, VK_NULL_HANDLE);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    const uint32_t validBits = queueFamily < queueFamilies.size() ? queueFamilies.at(queueFamily).timestampValidBits : 0;
+    if (validBits == 0)
+    {
+        return;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    m_device = device;
+    m_nanosecondsPerTick = static_cast<double>(properties.limits.timestampPeriod);
+    m_timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t{ 1 } << validBits) - 1;
+    m_logIntervalSeconds = logIntervalSeconds;
+    m_lastLog = std::chrono::steady_clock::now();
+
+    m_frames.resize(framesInFlight);
+    for (FrameQueries &frame : m_frames)
+    {
+        const VkQueryPoolCreateInfo createInfo = {
+            .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+            .pNext = VK_NULL_HANDLE,
+            .flags = 0,
+            .queryType = VK_QUERY_TYPE_TIMESTAMP,
+            .queryCount = QUERY_COUNT,
+            .pipelineStatistics = 0,
+        };
+
+        if (vkCreateQueryPool(m_device, &createInfo, VK_NULL_HANDLE, &frame.pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("vkCreateQueryPool() failed!");
+        }
+
+        frame.scopeNames.reserve(MAX_SCOPES);
+    }
+}
+
+void GpuProfiler::destroy(void)
+{
+    for (FrameQueries &frame : m_frames)
+    {
+        if (frame.pool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(m_device, frame.pool, VK_NULL_HANDLE);
+            frame.pool = VK_NULL_HANDLE;
+        }
+    }
+
+    m_frames.clear();
+    m_currentFrame = nullptr;
+    m_device = VK_NULL_HANDLE;
+}
+
+bool GpuProfiler::enabled(void) const
+{
+    return !m_frames.empty();
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer cmdBuffer, uint32_t frame)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    m_currentFrame = &m_frames.at(frame % m_frames.size());
+    collect(*m_currentFrame);
+
+    m_currentFrame->scopeNames.clear();
+    m_currentFrame->written = true;
+
+    vkCmdResetQueryPool(cmdBuffer, m_currentFrame->pool, 0, QUERY_COUNT);
+    vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_currentFrame->pool, 0);
+
+    if (m_logIntervalSeconds > 0.0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - m_lastLog).count() >= m_logIntervalSeconds)
+    {
+        log();
+        m_lastLog = std::chrono::steady_clock::now();
+    }
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer cmdBuffer)
+{
+    if (m_currentFrame == nullptr)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_currentFrame->pool, 1);
+    m_currentFrame = nullptr;
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer cmdBuffer, const char *name)
+{
+    if (m_currentFrame == nullptr || m_currentFrame->scopeNames.size() >= MAX_SCOPES)
+    {
+        return UINT32_MAX;
+    }
+
+    const uint32_t scope = static_cast<uint32_t>(m_currentFrame->scopeNames.size());
+    m_currentFrame->scopeNames.push_back(name);
+
+    vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_currentFrame->pool, FRAME_QUERIES + scope * 2);
+    return scope;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer cmdBuffer, uint32_t scope)
+{
+    if (m_currentFrame == nullptr || scope >= m_currentFrame->scopeNames.size())
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_currentFrame->pool, FRAME_QUERIES + scope * 2 + 1);
+}
+
+const GpuProfiler::ScopeStats &GpuProfiler::frameStats(void) const
+{
+    return m_frameStats;
+}
+
+std::span<const GpuProfiler::ScopeStats> GpuProfiler::scopeStats(void) const
+{
+    return m_scopeStats;
+}
+
+void GpuProfiler::collect(FrameQueries &frame)
+{
+    if (!frame.written)
+    {
+        return;
+    }
+
+    /* Every timestamp comes with an availability word, so a result that isn't there yet is skipped instead of waited for */
+    const uint32_t queryCount = FRAME_QUERIES + static_cast<uint32_t>(frame.scopeNames.size()) * 2;
+    std::array<uint64_t, QUERY_COUNT * 2> results{};
+
+    const VkResult result = vkGetQueryPoolResults(
+        m_device,
+        frame.pool,
+        0,
+        queryCount,
+        sizeof(uint64_t) * 2 * queryCount,
+        results.data(),
+        sizeof(uint64_t) * 2,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    if (result != VK_SUCCESS && result != VK_NOT_READY)
+    {
+        return;
+    }
+
+    auto timestamp = [&](const uint32_t query, uint64_t &value)
+    {
+        value = results.at(query * 2);
+        return results.at(query * 2 + 1) != 0;
+    };
+
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    if (timestamp(0, begin) && timestamp(1, end))
+    {
+        record(m_frameStats, begin, end);
+    }
+
+    for (uint32_t scope = 0; scope < frame.scopeNames.size(); scope++)
+    {
+        if (!timestamp(FRAME_QUERIES + scope * 2, begin) || !timestamp(FRAME_QUERIES + scope * 2 + 1, end))
+        {
+            continue;
+        }
+
+        const std::string_view name = frame.scopeNames.at(scope);
+        auto stats = std::find_if(m_scopeStats.begin(), m_scopeStats.end(), [&](const ScopeStats &entry) { return name == entry.name; });
+        if (stats == m_scopeStats.end())
+        {
+            m_scopeStats.push_back(ScopeStats{ .name = frame.scopeNames.at(scope) });
+            stats = std::prev(m_scopeStats.end());
+        }
+
+        record(*stats, begin, end);
+    }
+}
+
+void GpuProfiler::record(ScopeStats &stats, uint64_t begin, uint64_t end) const
+{
+    const double milliseconds = static_cast<double>((end - begin) & m_timestampMask) * m_nanosecondsPerTick / 1.0e6;
+
+    stats.averageMilliseconds = stats.samples == 0
+        ? milliseconds
+        : stats.averageMilliseconds + (milliseconds - stats.averageMilliseconds) * AVERAGE_WEIGHT;
+    stats.lastMilliseconds = milliseconds;
+    stats.samples++;
+}
+
+void GpuProfiler::log(void)
+{
+    std::print("gpu {:.3f} ms", m_frameStats.averageMilliseconds);
+    for (const ScopeStats &stats : m_scopeStats)
+    {
+        std::print(" | {} {:.3f} ms", stats.name, stats.averageMilliseconds);
+    }
+
+    std::println("");
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <volk/volk.h>
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/* Timestamp queries around named scopes of each frame. Every frame in flight has its own query pool, which is read back when
+   its slot comes around again - the fence of that slot has been waited on by then, so reading never stalls */
+class GpuProfiler
+{
+public:
+    static constexpr uint32_t MAX_SCOPES = 16;
+
+    struct ScopeStats
+    {
+        const char *name = nullptr;
+        double lastMilliseconds = 0.0;
+        double averageMilliseconds = 0.0; /* Exponential moving average over roughly the last 32 frames */
+        uint64_t samples = 0;             /* Frames measured so far, lastMilliseconds is new whenever this grows */
+    };
+
+    /* Ends the scope it was opened with when it goes out of scope */
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler &profiler, VkCommandBuffer cmdBuffer, const char *name);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        Scope(Scope &&) = delete;
+        Scope &operator=(Scope &&) = delete;
+
+    private:
+        GpuProfiler &m_profiler;
+        VkCommandBuffer m_cmdBuffer = VK_NULL_HANDLE;
+        uint32_t m_scope = UINT32_MAX;
+    };
+
+    /* Stays disabled (and every call a no-op) if the queue can't write timestamps. logIntervalSeconds <= 0 turns the log line off */
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, double logIntervalSeconds);
+    void destroy(void);
+
+    [[nodiscard]] bool enabled(void) const;
+
+    /* Record at the start and the end of a frame's command buffer, outside of any rendering */
+    void beginFrame(VkCommandBuffer cmdBuffer, uint32_t frame);
+    void endFrame(VkCommandBuffer cmdBuffer);
+
+    /* Names must outlive the profiler, string literals are the intended use. Returns UINT32_MAX when out of scopes */
+    [[nodiscard]] uint32_t beginScope(VkCommandBuffer cmdBuffer, const char *name);
+    void endScope(VkCommandBuffer cmdBuffer, uint32_t scope);
+
+    /* The whole frame, from beginFrame() to endFrame() */
+    [[nodiscard]] const ScopeStats &frameStats(void) const;
+    [[nodiscard]] std::span<const ScopeStats> scopeStats(void) const;
+
+private:
+    struct FrameQueries
+    {
+        VkQueryPool pool = VK_NULL_HANDLE;
+        std::vector<const char *> scopeNames{};
+        bool written = false;
+    };
+
+    void collect(FrameQueries &frame);
+    void record(ScopeStats &stats, uint64_t begin, uint64_t end) const;
+    void log(void);
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    double m_nanosecondsPerTick = 1.0;
+    uint64_t m_timestampMask = 0;
+    std::vector<FrameQueries> m_frames{};
+    FrameQueries *m_currentFrame = nullptr;
+
+    ScopeStats m_frameStats{ .name = "frame" };
+    std::vector<ScopeStats> m_scopeStats{};
+
+    double m_logIntervalSeconds = 0.0;
+    std::chrono::steady_clock::time_point m_lastLog{};
+};
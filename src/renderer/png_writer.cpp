@@ -0,0 +1,126 @@
+#include "renderer/png_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    constexpr std::array<uint32_t, 256> CRC_TABLE = []()
+    {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < table.size(); i++)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1u) != 0 ? 0xEDB88320u ^ (crc >> 1u) : crc >> 1u;
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+    /* Stored deflate blocks can't be longer than this */
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+
+    void appendBigEndian(std::vector<uint8_t> &bytes, const uint32_t value)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> 24u));
+        bytes.push_back(static_cast<uint8_t>(value >> 16u));
+        bytes.push_back(static_cast<uint8_t>(value >> 8u));
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void writeChunk(std::ofstream &file, const std::string_view type, std::span<const uint8_t> data)
+    {
+        std::vector<uint8_t> chunk;
+        chunk.reserve(data.size() + 12);
+        appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+        chunk.insert(chunk.end(), type.begin(), type.end());
+        chunk.insert(chunk.end(), data.begin(), data.end());
+
+        /* The CRC covers the type and the data, not the length */
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 4; i < chunk.size(); i++)
+        {
+            crc = CRC_TABLE[(crc ^ chunk[i]) & 0xFFu] ^ (crc >> 8u);
+        }
+        appendBigEndian(chunk, crc ^ 0xFFFFFFFFu);
+
+        file.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+    }
+}
+
+void writePng(const std::string &path, const uint32_t width, const uint32_t height, std::span<const uint8_t> rgba)
+{
+    const size_t rowSize = static_cast<size_t>(width) * 4;
+    if (width == 0 || height == 0 || rgba.size() != rowSize * height)
+    {
+        throw std::runtime_error("writePng(): " + path + " has no pixels or the wrong number of them!");
+    }
+
+    /* Every row starts with its filter type, 0 leaves the row as it is */
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve((rowSize + 1) * height);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgba.begin() + static_cast<ptrdiff_t>(rowSize * y), rgba.begin() + static_cast<ptrdiff_t>(rowSize * (y + 1)));
+    }
+
+    /* zlib stream of stored blocks: the header, the raw data in blocks of at most 64 KiB, then the Adler-32 of the data */
+    std::vector<uint8_t> compressed = { 0x78, 0x01 };
+    compressed.reserve(scanlines.size() + (scanlines.size() / MAX_STORED_BLOCK + 1) * 5 + 6);
+
+    size_t offset = 0;
+    do
+    {
+        const size_t blockSize = std::min(MAX_STORED_BLOCK, scanlines.size() - offset);
+        const bool lastBlock = offset + blockSize == scanlines.size();
+
+        compressed.push_back(lastBlock ? 1 : 0);
+        compressed.push_back(static_cast<uint8_t>(blockSize));
+        compressed.push_back(static_cast<uint8_t>(blockSize >> 8u));
+        compressed.push_back(static_cast<uint8_t>(~blockSize));
+        compressed.push_back(static_cast<uint8_t>(~blockSize >> 8u));
+        compressed.insert(compressed.end(), scanlines.begin() + static_cast<ptrdiff_t>(offset), scanlines.begin() + static_cast<ptrdiff_t>(offset + blockSize));
+
+        offset += blockSize;
+    } while (offset < scanlines.size());
+
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+    for (const uint8_t byte : scanlines)
+    {
+        adlerA = (adlerA + byte) % 65521u;
+        adlerB = (adlerB + adlerA) % 65521u;
+    }
+    appendBigEndian(compressed, (adlerB << 16u) | adlerA);
+
+    /* 8 bits per channel, RGBA, default compression, filtering and no interlacing */
+    std::vector<uint8_t> header;
+    appendBigEndian(header, width);
+    appendBigEndian(header, height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open " + path + " for writing!");
+    }
+
+    constexpr std::array<uint8_t, 8> SIGNATURE = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char *>(SIGNATURE.data()), SIGNATURE.size());
+    writeChunk(file, "IHDR", header);
+    writeChunk(file, "IDAT", compressed);
+    writeChunk(file, "IEND", {});
+
+    if (!file)
+    {
+        throw std::runtime_error("failed to write " + path + "!");
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+/* Writes tightly packed RGBA8 pixels, top row first, as a PNG. The image data is stored without compression - the files are
+   for golden-image checks and debugging, where being exact and dependency-free matters more than their size.
+   Throws if the file can't be written */
+void writePng(const std::string &path, const uint32_t width, const uint32_t height, std::span<const uint8_t> rgba);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+/* Everything the vertex shader needs. viewProjection is pushed once per frame, the chunk part before each chunk's draw */
+struct PushConstants
+{
+    alignas(16) glm::mat4 viewProjection; /* Camera-relative positions to clip space, the view has no translation */
+    alignas(16) glm::vec4 chunkOffset;    /* Chunk origin relative to the camera, w is unused */
+    uint64_t quadAddress;                 /* Device address of the chunk's quads, only read when pulling quads */
+};
+
+static constexpr uint32_t CHUNK_PUSH_CONSTANTS_OFFSET = offsetof(PushConstants, chunkOffset);
+static constexpr uint32_t CHUNK_PUSH_CONSTANTS_SIZE = sizeof(PushConstants) - CHUNK_PUSH_CONSTANTS_OFFSET;
+
+/* 128 bytes is the smallest maxPushConstantsSize any device may report */
+static_assert(sizeof(PushConstants) <= 128, "push constants have to fit in the guaranteed minimum");
@@ -17,12 +17,22 @@
 #include "stb_image.h"
 
 #include "renderer/renderer.hpp"
-#include "ubo.hpp"
+#include "renderer/block_textures.hpp"
+#include "renderer/gpu_profiler.hpp"
+#include "renderer/png_writer.hpp"
+#include "renderer/texture_container.hpp"
+#include "profiling/cpu_profiler.hpp"
+#include "push_constants.hpp"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <limits>
+#include <span>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -35,6 +45,25 @@ static const std::vector<const char *> requiredDeviceExtensions = {
     "VK_KHR_index_type_uint8"
 };
 
+static constexpr const char *PIPELINE_CACHE_FILE = "pipeline_cache.bin";
+
+/* Written in front of the driver's cache data. The data carries Vulkan's own header as well, but not every driver checks
+   it carefully, so anything that doesn't match the device and driver we're running on is never handed to the driver */
+struct PipelineCacheFileHeader
+{
+    static constexpr uint32_t MAGIC = 0x43504B56; /* "VKPC" */
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t vendorID = 0;
+    uint32_t deviceID = 0;
+    uint32_t driverVersion = 0;
+    uint32_t dataSize = 0;
+    std::array<uint8_t, VK_UUID_SIZE> driverUUID{};
+    std::array<uint8_t, VK_UUID_SIZE> pipelineCacheUUID{};
+};
+
 static const std::vector<const char *> validationLayers = { "VK_LAYER_KHRONOS_validation" };
 
 #ifdef NDEBUG
@@ -43,7 +72,7 @@ constexpr bool enableValidationLayers = false;
 constexpr bool enableValidationLayers = true;
 #endif
 
-void Renderer::init(SDL_Window *window, const World &world)
+void Renderer::init(SDL_Window *window, const Settings &settings)
 {
     if (!window)
     {
@@ -51,12 +80,35 @@ void Renderer::init(SDL_Window *window, const World &world)
     }
 
     m_window = window;
+    m_settings = settings;
     
     loadVulkan();
     createInstance();
     createSurface(window);
+    createDeviceObjects();
+}
+
+void Renderer::initHeadless(uint32_t width, uint32_t height, const Settings &settings)
+{
+    if (width == 0 || height == 0)
+    {
+        throw std::runtime_error("Renderer::initHeadless(): the image has no pixels!");
+    }
+
+    m_headless = true;
+    m_settings = settings;
+    m_swapChainExtent = { .width = width, .height = height };
+
+    loadVulkan();
+    createInstance();
+    createDeviceObjects();
+}
+
+void Renderer::createDeviceObjects(void)
+{
     pickPhysicalDevice();
     createLogicalDevice();
+    createPipelineCache();
     createSwapChain();
     createImageViews();
     createDescriptorSetLayout();
@@ -66,14 +118,13 @@ void Renderer::init(SDL_Window *window, const World &world)
     createTextureImage();
     createTextureImageView();
     createTextureSampler();
-    loadModel(world);
-    createVertexBuffer();
-    createIndexBuffer();
-    createUniformBuffers();
+    createQuadIndexBuffer();
     createDescriptorPool();
     createDescriptorSets();
     createCommandBuffers();
     createSyncObjects();
+
+    m_gpuProfiler.init(m_physicalDevice, m_device, m_queueFamilyIndices.graphicsFamily, MAX_FRAMES_IN_FLIGHT, m_settings.gpuProfilerLogSeconds);
 }
 
 void Renderer::cleanup(void)
@@ -110,7 +161,9 @@ void Renderer::cleanup(void)
         m_cmdPool = VK_NULL_HANDLE;
     }
 
+    m_gpuProfiler.destroy();
     destroyGeometryBuffers();
+    destroyBuffer(m_quadIndexBuffer);
 
     if (m_graphicsPipeline != VK_NULL_HANDLE)
     {
@@ -124,6 +177,13 @@ void Renderer::cleanup(void)
         m_pipelineLayout = VK_NULL_HANDLE;
     }
 
+    if (m_pipelineCache != VK_NULL_HANDLE)
+    {
+        savePipelineCache();
+        vkDestroyPipelineCache(m_device, m_pipelineCache, VK_NULL_HANDLE);
+        m_pipelineCache = VK_NULL_HANDLE;
+    }
+
     cleanupSwapChain();
 
     if (m_textureSampler != VK_NULL_HANDLE)
@@ -146,21 +206,7 @@ void Renderer::cleanup(void)
 
     if (m_textureImageMemory != VK_NULL_HANDLE)
     {
-        vkFreeMemory(m_device, m_textureImageMemory, VK_NULL_HANDLE);
-        m_textureImageMemory = VK_NULL_HANDLE;
-    }
-
-    for (uint8_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-    {
-        if (i < m_uniformBuffers.size() && m_uniformBuffers.at(i) != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(m_device, m_uniformBuffers.at(i), VK_NULL_HANDLE);
-        }
-
-        if (i < m_uniformBuffersMemory.size() && m_uniformBuffersMemory.at(i) != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, m_uniformBuffersMemory.at(i), VK_NULL_HANDLE);
-        }
+        freeMemory(m_textureImageMemory);
     }
 
     if (m_descriptorPool != VK_NULL_HANDLE)
@@ -196,13 +242,26 @@ void Renderer::cleanup(void)
 
 void Renderer::drawFrame(void)
 {
-    if (vkWaitForFences(m_device, 1, &m_inFlightFences.at(m_currentFrame), VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+    const CpuProfiler::Zone zone("Renderer::drawFrame");
+
     {
-        throw std::runtime_error("vkWaitForFences() failed!");
+        const CpuProfiler::Zone waitZone("vkWaitForFences");
+        if (vkWaitForFences(m_device, 1, &m_inFlightFences.at(m_currentFrame), VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+        {
+            throw std::runtime_error("vkWaitForFences() failed!");
+        }
     }
 
-    uint32_t imageIndex = 0;
-    VkResult result = vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, m_presentSemaphores.at(m_currentFrame), VK_NULL_HANDLE, &imageIndex);
+    releaseRetiredBuffers(m_currentFrame);
+
+    /* Headless, every frame in flight renders into an offscreen image of its own */
+    uint32_t imageIndex = m_currentFrame;
+    VkResult result = VK_SUCCESS;
+    if (!m_headless)
+    {
+        const CpuProfiler::Zone acquireZone("vkAcquireNextImageKHR");
+        result = vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, m_presentSemaphores.at(m_currentFrame), VK_NULL_HANDLE, &imageIndex);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -226,18 +285,33 @@ void Renderer::drawFrame(void)
     const VkSubmitInfo submitInfo = {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
         .pNext = VK_NULL_HANDLE,
-        .waitSemaphoreCount = 1,
+        .waitSemaphoreCount = m_headless ? 0u : 1u,
         .pWaitSemaphores = &m_presentSemaphores.at(m_currentFrame),
         .pWaitDstStageMask = &waitStages,
         .commandBufferCount = 1,
         .pCommandBuffers = &m_cmdBuffers.at(m_currentFrame),
-        .signalSemaphoreCount = 1,
+        .signalSemaphoreCount = m_headless ? 0u : 1u,
         .pSignalSemaphores = &m_graphicsSemaphores.at(m_currentFrame),
     };
 
-    if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences.at(m_currentFrame)) != VK_SUCCESS)
     {
-        throw std::runtime_error("vkQueueSubmit() failed!");
+        const CpuProfiler::Zone submitZone("vkQueueSubmit");
+        if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences.at(m_currentFrame)) != VK_SUCCESS)
+        {
+            throw std::runtime_error("vkQueueSubmit() failed!");
+        }
+    }
+
+    std::vector<GpuBuffer> &retiredBuffers = m_retiredBuffers.at(m_currentFrame);
+    retiredBuffers.insert(retiredBuffers.end(), m_pendingRetirements.begin(), m_pendingRetirements.end());
+    m_pendingRetirements.clear();
+
+    m_lastImageIndex = imageIndex;
+
+    if (m_headless)
+    {
+        m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        return;
     }
 
     const VkPresentInfoKHR presentInfo = {
@@ -251,7 +325,10 @@ void Renderer::drawFrame(void)
         .pResults = VK_NULL_HANDLE,
     };
 
-    result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
+    {
+        const CpuProfiler::Zone presentZone("vkQueuePresentKHR");
+        result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized)
     {
@@ -266,39 +343,155 @@ void Renderer::drawFrame(void)
     m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
-void Renderer::updateWorldMesh(World::Mesh mesh)
+void Renderer::updateChunkMesh(World::Mesh mesh)
 {
+    const CpuProfiler::Zone zone("Renderer::updateChunkMesh");
+
     if (m_device == VK_NULL_HANDLE)
     {
         return;
     }
 
-    if (vkDeviceWaitIdle(m_device) != VK_SUCCESS)
+    m_uploadStats.chunkMeshes++;
+    m_evictedGeometry.erase(mesh.coord);
+
+    /* The old geometry may still be read by frames in flight, so it is retired rather than destroyed */
+    const auto existing = m_chunkGeometry.find(mesh.coord);
+    if (existing != m_chunkGeometry.end())
     {
-        throw std::runtime_error("vkDeviceWaitIdle() failed!");
+        m_pendingRetirements.push_back(existing->second.buffer);
+        m_chunkGeometryBytes -= existing->second.size;
+        m_chunkGeometry.erase(existing);
     }
 
-    destroyGeometryBuffers();
-    m_vertices = std::move(mesh.vertices);
-    m_indices = std::move(mesh.indices);
-    createVertexBuffer();
-    createIndexBuffer();
+    if (mesh.empty())
+    {
+        return;
+    }
+
+    const bool pullQuads = m_settings.geometryMode == GeometryMode::QuadPulling;
+    const VkDeviceSize bufferSize = pullQuads
+        ? sizeof(ChunkQuad) * mesh.quads.size()
+        : sizeof(Voxel) * ChunkMesh::VERTICES_PER_QUAD * mesh.quads.size();
+
+    m_uploadStats.bytes += bufferSize;
+
+    PendingUpload upload{};
+    upload.size = bufferSize;
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, upload.staging.buffer, upload.staging.memory);
+
+    void *data = VK_NULL_HANDLE;
+    vkMapMemory(m_device, upload.staging.memory, 0, bufferSize, 0, &data);
+    if (pullQuads)
+    {
+        memcpy(data, mesh.quads.data(), static_cast<size_t>(bufferSize));
+    }
+    else
+    {
+        Voxel *vertices = static_cast<Voxel *>(data);
+        for (size_t i = 0; i < mesh.quads.size(); i++)
+        {
+            ChunkMesher::expandQuad(mesh.quads[i], std::span<Voxel, ChunkMesh::VERTICES_PER_QUAD>(vertices + i * ChunkMesh::VERTICES_PER_QUAD, ChunkMesh::VERTICES_PER_QUAD));
+        }
+    }
+    vkUnmapMemory(m_device, upload.staging.memory);
+
+    ChunkGeometry geometry{};
+    geometry.size = bufferSize;
+    geometry.quadCount = mesh.quadCount();
+    geometry.directionOffsets = mesh.directionOffsets;
+
+    const VkBufferUsageFlags usage = pullQuads
+        ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+        : VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, geometry.buffer.buffer, geometry.buffer.memory);
+
+    if (pullQuads)
+    {
+        const VkBufferDeviceAddressInfo addressInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = VK_NULL_HANDLE,
+            .buffer = geometry.buffer.buffer,
+        };
+        geometry.quadAddress = vkGetBufferDeviceAddress(m_device, &addressInfo);
+    }
+
+    upload.destination = geometry.buffer.buffer;
+    m_pendingUploads.push_back(upload);
+    m_chunkGeometryBytes += geometry.size;
+    m_chunkGeometry.emplace(mesh.coord, geometry);
 }
 
-void Renderer::updateUniformBuffer(const Camera &camera)
+void Renderer::updateGeometryResidency(std::vector<ChunkCoord> &restore)
 {
-    const uint32_t currentFrame = m_currentFrame;
-    if (currentFrame >= m_uniformBuffersMapped.size())
+    const float cameraX = m_cameraPosition.x / static_cast<float>(Chunk::WIDTH);
+    const float cameraZ = m_cameraPosition.z / static_cast<float>(Chunk::DEPTH);
+    const float viewRadius = static_cast<float>(m_settings.geometryViewRadius);
+
+    auto distance = [&](const ChunkCoord coord)
+    {
+        const float dx = static_cast<float>(coord.x) + 0.5f - cameraX;
+        const float dz = static_cast<float>(coord.z) + 0.5f - cameraZ;
+        return std::sqrt(dx * dx + dz * dz);
+    };
+
+    for (auto it = m_evictedGeometry.begin(); it != m_evictedGeometry.end();)
+    {
+        if (distance(*it) <= viewRadius)
+        {
+            restore.push_back(*it);
+            it = m_evictedGeometry.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (m_settings.geometryBudgetBytes == 0 || m_chunkGeometryBytes <= m_settings.geometryBudgetBytes)
     {
         return;
     }
 
-    UniformBufferObject ubo{};
-    ubo.model = glm::mat4(1.0f);
-    ubo.view = camera.viewMatrix();
-    ubo.projection = camera.projectionMatrix(static_cast<float>(m_swapChainExtent.width) / static_cast<float>(m_swapChainExtent.height));
+    const CpuProfiler::Zone zone("Renderer::updateGeometryResidency");
+
+    std::vector<std::pair<float, ChunkCoord>> candidates;
+    for (const auto &[coord, geometry] : m_chunkGeometry)
+    {
+        const float chunkDistance = distance(coord);
+        if (chunkDistance > viewRadius)
+        {
+            candidates.emplace_back(chunkDistance, coord);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+    /* Retired like replaced geometry, frames in flight may still draw it. A pending upload into it is recorded before it goes */
+    for (const auto &[chunkDistance, coord] : candidates)
+    {
+        if (m_chunkGeometryBytes <= m_settings.geometryBudgetBytes)
+        {
+            break;
+        }
+
+        const auto geometry = m_chunkGeometry.find(coord);
+        m_pendingRetirements.push_back(geometry->second.buffer);
+        m_chunkGeometryBytes -= geometry->second.size;
+        m_chunkGeometry.erase(geometry);
+        m_evictedGeometry.insert(coord);
+    }
+}
+
+void Renderer::updateCamera(const Camera &camera)
+{
+    const float aspectRatio = static_cast<float>(m_swapChainExtent.width) / static_cast<float>(m_swapChainExtent.height);
+    const glm::mat4 projection = m_settings.depthMode == DepthMode::ReverseInfinite
+        ? camera.reverseInfiniteProjectionMatrix(aspectRatio)
+        : camera.projectionMatrix(aspectRatio);
 
-    memcpy(m_uniformBuffersMapped.at(currentFrame), &ubo, sizeof(ubo));
+    m_viewProjection = projection * camera.viewRotationMatrix();
+    m_cameraPosition = camera.position();
 }
 
 void Renderer::setFramebufferResized(bool resized)
@@ -340,11 +533,16 @@ void Renderer::createInstance(void)
         requiredLayers = validationLayers;
     }
 
+    /* Headless rendering never touches a surface, so it needs no window system extensions (and no SDL) */
     uint32_t sdlExtensionCount = 0;
-    auto sdlExtensions = SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
-    if (!sdlExtensions)
+    const char *const *sdlExtensions = VK_NULL_HANDLE;
+    if (!m_headless)
     {
-        throw std::runtime_error("SDL_Vulkan_GetInstanceExtensions() failed: " + std::string(SDL_GetError()));
+        sdlExtensions = SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount);
+        if (!sdlExtensions)
+        {
+            throw std::runtime_error("SDL_Vulkan_GetInstanceExtensions() failed: " + std::string(SDL_GetError()));
+        }
     }
 
     const VkInstanceCreateInfo createInfo = {
@@ -397,13 +595,17 @@ Renderer::QueueFamilyIndices Renderer::findQueueFamilies(const VkPhysicalDevice
         }
 
         VkBool32 presentSupport = VK_FALSE;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
+        if (!m_headless)
+        {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
+        }
+
         if (presentSupport == VK_TRUE)
         {
             indices.presentFamily = i;
         }
 
-        if (indices.isComplete())
+        if (indices.isComplete(!m_headless))
         {
             break;
         }
@@ -440,7 +642,7 @@ void Renderer::pickPhysicalDevice(void)
         vkEnumerateDeviceExtensionProperties(physicalDevice, VK_NULL_HANDLE, &extensionCount, extensions.data());
 
         const QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
-        if (!queueFamilyIndices.isComplete())
+        if (!queueFamilyIndices.isComplete(!m_headless))
         {
             continue;
         }
@@ -456,8 +658,12 @@ void Renderer::pickPhysicalDevice(void)
         }
 
         VkBool32 supportsSurface = VK_FALSE;
-        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, queueFamilyIndices.presentFamily, m_surface, &supportsSurface);
-        if (supportsSurface != VK_TRUE)
+        if (!m_headless)
+        {
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, queueFamilyIndices.presentFamily, m_surface, &supportsSurface);
+        }
+
+        if (!m_headless && supportsSurface != VK_TRUE)
         {
             continue;
         }
@@ -477,7 +683,7 @@ void Renderer::createLogicalDevice(void)
 {
     constexpr float queuePriority = 1.0f;
     std::vector<uint32_t> uniqueQueueFamilies = { m_queueFamilyIndices.graphicsFamily };
-    if (m_queueFamilyIndices.presentFamily != m_queueFamilyIndices.graphicsFamily)
+    if (!m_headless && m_queueFamilyIndices.presentFamily != m_queueFamilyIndices.graphicsFamily)
     {
         uniqueQueueFamilies.push_back(m_queueFamilyIndices.presentFamily);
     }
@@ -500,9 +706,18 @@ void Renderer::createLogicalDevice(void)
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+    /* Core since Vulkan 1.2 and required by 1.3, pulled quads are read through their buffer's device address */
+    VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES,
+        .pNext = nullptr,
+        .bufferDeviceAddress = VK_TRUE,
+        .bufferDeviceAddressCaptureReplay = VK_FALSE,
+        .bufferDeviceAddressMultiDevice = VK_FALSE,
+    };
+
     VkPhysicalDeviceSynchronization2Features synchronization2Features = {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
-        .pNext = nullptr,
+        .pNext = &bufferDeviceAddressFeatures,
         .synchronization2 = VK_TRUE,
     };
 
@@ -524,6 +739,31 @@ void Renderer::createLogicalDevice(void)
         .indexTypeUint8 = VK_TRUE,
     };
 
+    std::vector<const char *> deviceExtensions;
+    for (const char *extension : requiredDeviceExtensions)
+    {
+        if (!m_headless || std::strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) != 0)
+        {
+            deviceExtensions.push_back(extension);
+        }
+    }
+
+    /* Optional, lets memoryStats() report how much the driver thinks we can still allocate per heap */
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, VK_NULL_HANDLE, &extensionCount, VK_NULL_HANDLE);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, VK_NULL_HANDLE, &extensionCount, extensions.data());
+
+    m_memoryBudgetSupported = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties &extension)
+    {
+        return std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+    });
+
+    if (m_memoryBudgetSupported)
+    {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
     const VkDeviceCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
         .pNext = &indexTypeUint8Features,
@@ -532,8 +772,8 @@ void Renderer::createLogicalDevice(void)
         .pQueueCreateInfos = queueCreateInfos.data(),
         .enabledLayerCount = 0,
         .ppEnabledLayerNames = VK_NULL_HANDLE,
-        .enabledExtensionCount = static_cast<uint32_t>(requiredDeviceExtensions.size()),
-        .ppEnabledExtensionNames = requiredDeviceExtensions.data(),
+        .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
+        .ppEnabledExtensionNames = deviceExtensions.data(),
         .pEnabledFeatures = &deviceFeatures,
     };
 
@@ -542,14 +782,33 @@ void Renderer::createLogicalDevice(void)
         throw std::runtime_error("vkCreateDevice() failed!");
     }
 
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memoryProperties);
+
+    m_memoryTypeStats.assign(memoryProperties.memoryTypeCount, MemoryStats::MemoryType{});
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        m_memoryTypeStats.at(i).flags = memoryProperties.memoryTypes[i].propertyFlags;
+        m_memoryTypeStats.at(i).heapIndex = memoryProperties.memoryTypes[i].heapIndex;
+    }
+
     vkGetDeviceQueue(m_device, m_queueFamilyIndices.graphicsFamily, 0, &m_graphicsQueue);
-    vkGetDeviceQueue(m_device, m_queueFamilyIndices.presentFamily, 0, &m_presentQueue);
+    if (!m_headless)
+    {
+        vkGetDeviceQueue(m_device, m_queueFamilyIndices.presentFamily, 0, &m_presentQueue);
+    }
 
     volkLoadDevice(m_device);
 }
 
 void Renderer::createSwapChain(void)
 {
+    if (m_headless)
+    {
+        createOffscreenImages();
+        return;
+    }
+
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &m_swapChainCapabilities);
 
     if (m_swapChainCapabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
@@ -658,8 +917,7 @@ void Renderer::cleanupSwapChain(void)
 
     if (m_depthImageMemory != VK_NULL_HANDLE)
     {
-        vkFreeMemory(m_device, m_depthImageMemory, VK_NULL_HANDLE);
-        m_depthImageMemory = VK_NULL_HANDLE;
+        freeMemory(m_depthImageMemory);
     }
 
     for (auto imageView : m_swapChainImageViews)
@@ -676,10 +934,55 @@ void Renderer::cleanupSwapChain(void)
         vkDestroySwapchainKHR(m_device, m_swapChain, VK_NULL_HANDLE);
         m_swapChain = VK_NULL_HANDLE;
     }
+
+    /* Swap chain images belong to the swap chain, offscreen ones are ours */
+    if (m_headless)
+    {
+        for (VkImage image : m_swapChainImages)
+        {
+            vkDestroyImage(m_device, image, VK_NULL_HANDLE);
+        }
+
+        for (VkDeviceMemory &memory : m_offscreenImageMemory)
+        {
+            freeMemory(memory);
+        }
+
+        m_offscreenImageMemory.clear();
+    }
+
+    m_swapChainImages.clear();
+    m_lastImageIndex = UINT32_MAX;
+}
+
+void Renderer::createOffscreenImages(void)
+{
+    /* Same as the swap chain's B8G8R8A8_SRGB apart from the channel order, which is what readbacks and PNGs want */
+    m_swapChainImageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+
+    m_swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    m_offscreenImageMemory.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (uint8_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        createImage(
+            m_swapChainExtent.width,
+            m_swapChainExtent.height,
+            1,
+            1,
+            m_swapChainImageFormat,
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_swapChainImages.at(i),
+            m_offscreenImageMemory.at(i));
+    }
 }
 
 void Renderer::recreateSwapChain(void)
 {
+    const CpuProfiler::Zone zone("Renderer::recreateSwapChain");
+
     if (vkDeviceWaitIdle(m_device) != VK_SUCCESS)
     {
         throw std::runtime_error("vkDeviceWaitIdle() failed!");
@@ -691,14 +994,14 @@ void Renderer::recreateSwapChain(void)
     createDepthResources();
 }
 
-VkImageView Renderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+VkImageView Renderer::createImageView(VkImage image, VkImageViewType viewType, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, uint32_t layerCount)
 {
     const VkImageViewCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
         .pNext = VK_NULL_HANDLE,
         .flags = 0,
         .image = image,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .viewType = viewType,
         .format = format,
         .components = {
             .r = VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -709,9 +1012,9 @@ VkImageView Renderer::createImageView(VkImage image, VkFormat format, VkImageAsp
         .subresourceRange = {
             .aspectMask = aspectFlags,
             .baseMipLevel = 0,
-            .levelCount = 1,
+            .levelCount = mipLevels,
             .baseArrayLayer = 0,
-            .layerCount = 1,
+            .layerCount = layerCount,
         },
     };
 
@@ -731,29 +1034,21 @@ void Renderer::createImageViews(void)
 
     for (size_t i = 0; i < m_swapChainImageViews.size(); i++)
     {
-        m_swapChainImageViews.at(i) = createImageView(m_swapChainImages.at(i), m_swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+        m_swapChainImageViews.at(i) = createImageView(m_swapChainImages.at(i), VK_IMAGE_VIEW_TYPE_2D, m_swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1);
     }
 }
 
 void Renderer::createDescriptorSetLayout(void)
 {
-    constexpr VkDescriptorSetLayoutBinding layoutBinding = {
-        .binding = 0,
-        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-        .descriptorCount = 1,
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-        .pImmutableSamplers = VK_NULL_HANDLE,
-    };
-
     constexpr VkDescriptorSetLayoutBinding samplerBinding = {
-        .binding = 1,
+        .binding = 0,
         .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
         .descriptorCount = 1,
         .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
         .pImmutableSamplers = VK_NULL_HANDLE,
     };
 
-    constexpr std::array<VkDescriptorSetLayoutBinding, 2> bindings = { layoutBinding, samplerBinding };
+    constexpr std::array<VkDescriptorSetLayoutBinding, 1> bindings = { samplerBinding };
 
     const VkDescriptorSetLayoutCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -844,6 +1139,8 @@ void Renderer::createGraphicsPipeline()
         .pScissors = &scissor,
     };
 
+    /* Pulled quads are read straight from memory by the vertex shader, so that pipeline has no vertex input at all */
+    const bool pullQuads = m_settings.geometryMode == GeometryMode::QuadPulling;
     constexpr auto bindingDescription = Voxel::getBindingDescription();
     constexpr auto attributeDescriptions = Voxel::getAttributeDescriptions();
 
@@ -851,10 +1148,10 @@ void Renderer::createGraphicsPipeline()
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
         .pNext = VK_NULL_HANDLE,
         .flags = 0,
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &bindingDescription,
-        .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
-        .pVertexAttributeDescriptions = attributeDescriptions.data(),
+        .vertexBindingDescriptionCount = pullQuads ? 0u : 1u,
+        .pVertexBindingDescriptions = pullQuads ? VK_NULL_HANDLE : &bindingDescription,
+        .vertexAttributeDescriptionCount = pullQuads ? 0u : static_cast<uint32_t>(attributeDescriptions.size()),
+        .pVertexAttributeDescriptions = pullQuads ? VK_NULL_HANDLE : attributeDescriptions.data(),
     };
 
     const VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo = {
@@ -872,7 +1169,7 @@ void Renderer::createGraphicsPipeline()
         .flags = 0,
         .stage = VK_SHADER_STAGE_VERTEX_BIT,
         .module = vertShaderModule,
-        .pName = "vertMain",
+        .pName = pullQuads ? "vertPulled" : "vertMain",
         .pSpecializationInfo = VK_NULL_HANDLE,
     };
 
@@ -923,7 +1220,7 @@ void Renderer::createGraphicsPipeline()
         .flags = 0,
         .depthTestEnable = VK_TRUE,
         .depthWriteEnable = VK_TRUE,
-        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthCompareOp = m_settings.depthMode == DepthMode::ReverseInfinite ? VK_COMPARE_OP_GREATER : VK_COMPARE_OP_LESS,
         .depthBoundsTestEnable = VK_FALSE,
         .stencilTestEnable = VK_FALSE,
         .front = {},
@@ -954,14 +1251,20 @@ void Renderer::createGraphicsPipeline()
         .blendConstants = {0.0f, 0.0f, 0.0f, 0.0f},
     };
 
+    const VkPushConstantRange pushConstantRange = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset = 0,
+        .size = sizeof(PushConstants),
+    };
+
     const VkPipelineLayoutCreateInfo pipelineLayoutInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .pNext = VK_NULL_HANDLE,
         .flags = 0,
         .setLayoutCount = 1,
         .pSetLayouts = &m_descriptorSetLayout,
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = VK_NULL_HANDLE,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
     };
 
     if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, VK_NULL_HANDLE, &m_pipelineLayout) != VK_SUCCESS)
@@ -1002,15 +1305,257 @@ void Renderer::createGraphicsPipeline()
         .basePipelineIndex = -1,
     };
 
-    if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, VK_NULL_HANDLE, &m_graphicsPipeline) != VK_SUCCESS)
+    const auto creationStart = std::chrono::steady_clock::now();
+
+    if (vkCreateGraphicsPipelines(m_device, m_pipelineCache, 1, &pipelineInfo, VK_NULL_HANDLE, &m_graphicsPipeline) != VK_SUCCESS)
     {
         throw std::runtime_error("vkCreateGraphicsPipelines() failed!");
     }
 
+    m_pipelineCacheStats.pipelineCreationMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - creationStart).count();
+
     vkDestroyShaderModule(m_device, fragShaderModule, VK_NULL_HANDLE);
     vkDestroyShaderModule(m_device, vertShaderModule, VK_NULL_HANDLE);
 }
 
+static PipelineCacheFileHeader pipelineCacheHeaderFor(VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceIDProperties idProperties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+        .pNext = VK_NULL_HANDLE,
+    };
+
+    VkPhysicalDeviceProperties2 properties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &idProperties,
+    };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    PipelineCacheFileHeader header{
+        .vendorID = properties.properties.vendorID,
+        .deviceID = properties.properties.deviceID,
+        .driverVersion = properties.properties.driverVersion,
+    };
+    std::copy_n(idProperties.driverUUID, VK_UUID_SIZE, header.driverUUID.begin());
+    std::copy_n(properties.properties.pipelineCacheUUID, VK_UUID_SIZE, header.pipelineCacheUUID.begin());
+
+    return header;
+}
+
+void Renderer::createPipelineCache(void)
+{
+    const PipelineCacheFileHeader expected = pipelineCacheHeaderFor(m_physicalDevice);
+
+    /* A missing, truncated or foreign file just means starting with an empty cache */
+    std::vector<char> initialData{};
+    std::ifstream file(PIPELINE_CACHE_FILE, std::ios::binary);
+    PipelineCacheFileHeader header{};
+    if (file.is_open() && file.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+        header.magic == expected.magic && header.version == expected.version &&
+        header.vendorID == expected.vendorID && header.deviceID == expected.deviceID && header.driverVersion == expected.driverVersion &&
+        header.driverUUID == expected.driverUUID && header.pipelineCacheUUID == expected.pipelineCacheUUID)
+    {
+        initialData.resize(header.dataSize);
+        if (!file.read(initialData.data(), static_cast<std::streamsize>(initialData.size())))
+        {
+            initialData.clear();
+        }
+    }
+
+    const VkPipelineCacheCreateInfo createInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = VK_NULL_HANDLE,
+        .flags = 0,
+        .initialDataSize = initialData.size(),
+        .pInitialData = initialData.empty() ? VK_NULL_HANDLE : initialData.data(),
+    };
+
+    if (vkCreatePipelineCache(m_device, &createInfo, VK_NULL_HANDLE, &m_pipelineCache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("vkCreatePipelineCache() failed!");
+    }
+
+    m_pipelineCacheStats.loadedFromDisk = !initialData.empty();
+    m_pipelineCacheStats.loadedBytes = initialData.size();
+}
+
+void Renderer::savePipelineCache(void)
+{
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, VK_NULL_HANDLE) != VK_SUCCESS || dataSize == 0)
+    {
+        return;
+    }
+
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+    {
+        return;
+    }
+
+    PipelineCacheFileHeader header = pipelineCacheHeaderFor(m_physicalDevice);
+    header.dataSize = static_cast<uint32_t>(dataSize);
+
+    /* Written next to the old cache and then moved over it, so a crash halfway through never leaves a broken file behind */
+    const std::string temporaryFile = std::string(PIPELINE_CACHE_FILE) + ".tmp";
+    {
+        std::ofstream file(temporaryFile, std::ios::binary | std::ios::trunc);
+        if (!file.is_open() ||
+            !file.write(reinterpret_cast<const char *>(&header), sizeof(header)) ||
+            !file.write(data.data(), static_cast<std::streamsize>(dataSize)))
+        {
+            return;
+        }
+    }
+
+    std::error_code error{};
+    std::filesystem::rename(temporaryFile, PIPELINE_CACHE_FILE, error);
+    if (!error)
+    {
+        m_pipelineCacheStats.savedBytes = dataSize;
+    }
+}
+
+const Renderer::PipelineCacheStats &Renderer::pipelineCacheStats(void) const
+{
+    return m_pipelineCacheStats;
+}
+
+const GpuProfiler &Renderer::gpuProfiler(void) const
+{
+    return m_gpuProfiler;
+}
+
+const Renderer::UploadStats &Renderer::uploadStats(void) const
+{
+    return m_uploadStats;
+}
+
+Renderer::MemoryStats Renderer::memoryStats(void) const
+{
+    MemoryStats stats{
+        .types = m_memoryTypeStats,
+        .allocatedBytes = m_allocatedBytes,
+        .peakAllocatedBytes = m_peakAllocatedBytes,
+        .budgetAvailable = m_memoryBudgetSupported,
+        .chunkGeometryBytes = m_chunkGeometryBytes,
+        .evictedGeometryCount = m_evictedGeometry.size(),
+    };
+
+    if (m_physicalDevice == VK_NULL_HANDLE)
+    {
+        return stats;
+    }
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties.pNext = m_memoryBudgetSupported ? &budget : VK_NULL_HANDLE;
+    vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &properties);
+
+    const VkPhysicalDeviceMemoryProperties &memoryProperties = properties.memoryProperties;
+    stats.heaps.reserve(memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++)
+    {
+        stats.heaps.push_back(MemoryStats::MemoryHeap{
+            .flags = memoryProperties.memoryHeaps[i].flags,
+            .size = memoryProperties.memoryHeaps[i].size,
+            .budget = m_memoryBudgetSupported ? budget.heapBudget[i] : 0,
+            .usage = m_memoryBudgetSupported ? budget.heapUsage[i] : 0,
+        });
+    }
+
+    return stats;
+}
+
+bool Renderer::headless(void) const
+{
+    return m_headless;
+}
+
+Renderer::FrameCapture Renderer::captureFrame(void)
+{
+    if (!m_headless)
+    {
+        throw std::runtime_error("Renderer::captureFrame(): only headless frames can be read back!");
+    }
+
+    if (m_lastImageIndex == UINT32_MAX)
+    {
+        throw std::runtime_error("Renderer::captureFrame(): no frame has been drawn yet!");
+    }
+
+    FrameCapture capture{};
+    capture.width = m_swapChainExtent.width;
+    capture.height = m_swapChainExtent.height;
+
+    const VkDeviceSize size = static_cast<VkDeviceSize>(capture.width) * capture.height * 4;
+
+    GpuBuffer readback{};
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, readback.buffer, readback.memory);
+
+    /* Submitted after the frame, so the barrier at the end of the frame already covers this copy */
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+    const VkBufferImageCopy region = {
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+        .imageOffset = { .x = 0, .y = 0, .z = 0 },
+        .imageExtent = { .width = capture.width, .height = capture.height, .depth = 1 },
+    };
+
+    vkCmdCopyImageToBuffer(commandBuffer, m_swapChainImages.at(m_lastImageIndex), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+
+    const VkMemoryBarrier2 hostBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .pNext = VK_NULL_HANDLE,
+        .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+        .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+    };
+
+    const VkDependencyInfo dependencyInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext = VK_NULL_HANDLE,
+        .dependencyFlags = 0,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &hostBarrier,
+        .bufferMemoryBarrierCount = 0,
+        .pBufferMemoryBarriers = VK_NULL_HANDLE,
+        .imageMemoryBarrierCount = 0,
+        .pImageMemoryBarriers = VK_NULL_HANDLE,
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+    endSingleTimeCommands(commandBuffer);
+
+    capture.pixels.resize(static_cast<size_t>(size));
+
+    void *data = VK_NULL_HANDLE;
+    vkMapMemory(m_device, readback.memory, 0, size, 0, &data);
+    std::memcpy(capture.pixels.data(), data, capture.pixels.size());
+    vkUnmapMemory(m_device, readback.memory);
+
+    destroyBuffer(readback);
+    return capture;
+}
+
+void Renderer::saveFrame(const std::string &path)
+{
+    const FrameCapture capture = captureFrame();
+    writePng(path, capture.width, capture.height, capture.pixels);
+}
+
 void Renderer::createCommandPool(void)
 {
     const VkCommandPoolCreateInfo createInfo = {
@@ -1049,6 +1594,16 @@ VkFormat Renderer::findSupportedFormat(const std::vector<VkFormat> &candidates,
 
 VkFormat Renderer::findDepthFormat(void) const
 {
+    /* Reverse-Z only pays off with floating point depth, fixed point formats spread their precision evenly */
+    if (m_settings.depthMode == DepthMode::ReverseInfinite)
+    {
+        return findSupportedFormat(
+            { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT },
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+        );
+    }
+
     return findSupportedFormat(
         { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
         VK_IMAGE_TILING_OPTIMAL,
@@ -1064,11 +1619,11 @@ bool Renderer::hasStencilComponent(const VkFormat &format) const
 void Renderer::createDepthResources()
 {
     const VkFormat depthFormat = findDepthFormat();
-    createImage(m_swapChainExtent.width, m_swapChainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory);
-    m_depthImageView = createImageView(m_depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+    createImage(m_swapChainExtent.width, m_swapChainExtent.height, 1, 1, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory);
+    m_depthImageView = createImageView(m_depthImage, VK_IMAGE_VIEW_TYPE_2D, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1);
 }
 
-void Renderer::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory)
+void Renderer::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory)
 {
     const VkImageCreateInfo imageInfo = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
@@ -1081,8 +1636,8 @@ void Renderer::createImage(uint32_t width, uint32_t height, VkFormat format, VkI
             .height = height,
             .depth = 1,
         },
-        .mipLevels = 1,
-        .arrayLayers = 1,
+        .mipLevels = mipLevels,
+        .arrayLayers = arrayLayers,
         .samples = VK_SAMPLE_COUNT_1_BIT,
         .tiling = tiling,
         .usage = usage,
@@ -1107,15 +1662,12 @@ void Renderer::createImage(uint32_t width, uint32_t height, VkFormat format, VkI
         .memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties),
     };
 
-    if (vkAllocateMemory(m_device, &allocInfo, VK_NULL_HANDLE, &imageMemory) != VK_SUCCESS)
-    {
-        throw std::runtime_error("vkAllocateMemory() failed!");
-    }
+    imageMemory = allocateMemory(allocInfo, AllocationKind::Image);
 
     vkBindImageMemory(m_device, image, imageMemory, 0);
 }
 
-void Renderer::transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout)
+void Renderer::transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount)
 {
     VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
@@ -1132,9 +1684,9 @@ void Renderer::transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkI
         .subresourceRange = {
             .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
             .baseMipLevel = 0,
-            .levelCount = 1,
+            .levelCount = mipLevels,
             .baseArrayLayer = 0,
-            .layerCount = 1,
+            .layerCount = layerCount,
         },
     };
 
@@ -1178,7 +1730,7 @@ void Renderer::transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkI
     endSingleTimeCommands(commandBuffer);
 }
 
-void Renderer::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+void Renderer::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount)
 {
     VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
@@ -1190,7 +1742,7 @@ void Renderer::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width,
             .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
             .mipLevel = 0,
             .baseArrayLayer = 0,
-            .layerCount = 1,
+            .layerCount = layerCount, /* Layers follow each other tightly packed in the buffer */
         },
         .imageOffset = { .x = 0, .y = 0, .z = 0 },
         .imageExtent = { .width = width, .height = height, .depth = 1 },
@@ -1257,16 +1809,96 @@ void Renderer::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 
 void Renderer::createTextureImage(void)
 {
-    int texWidth = 0;
-    int texHeight = 0;
-    int texChannels = 0;
-    stbi_uc *pixels = stbi_load("resources/textures/atlas.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    if (!pixels)
+    if (createBakedTextureImage())
+    {
+        return;
+    }
+
+    /* Every layer is loaded into one staging buffer, back to back in BlockTexture order */
+    std::vector<stbi_uc> layerPixels{};
+    uint32_t layerWidth = 0;
+    uint32_t layerHeight = 0;
+
+    for (const char *filename : BLOCK_TEXTURE_FILES)
+    {
+        int texWidth = 0;
+        int texHeight = 0;
+        int texChannels = 0;
+        stbi_uc *pixels = stbi_load(filename, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            throw std::runtime_error("stbi_load() failed!");
+        }
+
+        if (layerPixels.empty())
+        {
+            layerWidth = static_cast<uint32_t>(texWidth);
+            layerHeight = static_cast<uint32_t>(texHeight);
+        }
+        else if (static_cast<uint32_t>(texWidth) != layerWidth || static_cast<uint32_t>(texHeight) != layerHeight)
+        {
+            stbi_image_free(pixels);
+            throw std::runtime_error("block textures must all be the same size!");
+        }
+
+        layerPixels.insert(layerPixels.end(), pixels, pixels + static_cast<size_t>(texWidth) * static_cast<size_t>(texHeight) * 4);
+        stbi_image_free(pixels);
+    }
+
+    const uint32_t layerCount = static_cast<uint32_t>(BLOCK_TEXTURE_FILES.size());
+    m_textureMipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(layerWidth, layerHeight)))) + 1;
+
+    const VkDeviceSize imageSize = static_cast<VkDeviceSize>(layerPixels.size());
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+
+    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    void *data = VK_NULL_HANDLE;
+    vkMapMemory(m_device, stagingBufferMemory, 0, imageSize, 0, &data);
+    memcpy(data, layerPixels.data(), static_cast<size_t>(imageSize));
+    vkUnmapMemory(m_device, stagingBufferMemory);
+
+    /* The smaller mip levels are blitted from the first one, so the image is a transfer source as well */
+    createImage(layerWidth, layerHeight, m_textureMipLevels, layerCount, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageMemory);
+    transitionImageLayout(m_textureImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_textureMipLevels, layerCount);
+    copyBufferToImage(stagingBuffer, m_textureImage, layerWidth, layerHeight, layerCount);
+    generateMipmaps(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, layerWidth, layerHeight, m_textureMipLevels, layerCount);
+
+    vkDestroyBuffer(m_device, stagingBuffer, VK_NULL_HANDLE);
+    freeMemory(stagingBufferMemory);
+}
+
+bool Renderer::createBakedTextureImage(void)
+{
+    /* A container older than any of its source images is stale, so the PNGs are decoded instead */
+    std::error_code error{};
+    const std::filesystem::file_time_type bakedTime = std::filesystem::last_write_time(BAKED_BLOCK_TEXTURES_FILE, error);
+    if (error)
+    {
+        return false;
+    }
+
+    for (const char *filename : BLOCK_TEXTURE_FILES)
+    {
+        const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(filename, error);
+        if (!error && sourceTime > bakedTime)
+        {
+            return false;
+        }
+    }
+
+    MappedTextureContainer container{};
+    if (!container.open(BAKED_BLOCK_TEXTURES_FILE) || container.header().layerCount != BLOCK_TEXTURE_FILES.size())
     {
-        throw std::runtime_error("stbi_load() failed!");
+        return false;
     }
 
-    const VkDeviceSize imageSize = static_cast<VkDeviceSize>(texWidth) * static_cast<VkDeviceSize>(texHeight) * 4;
+    const TextureContainerHeader &header = container.header();
+    const std::span<const std::byte> texels = container.texels();
+
+    /* The container's levels are laid out exactly like the image copies want them, so loading is a single memcpy */
+    const VkDeviceSize imageSize = static_cast<VkDeviceSize>(texels.size());
     VkBuffer stagingBuffer = VK_NULL_HANDLE;
     VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
 
@@ -1274,22 +1906,160 @@ void Renderer::createTextureImage(void)
 
     void *data = VK_NULL_HANDLE;
     vkMapMemory(m_device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
+    memcpy(data, texels.data(), texels.size());
     vkUnmapMemory(m_device, stagingBufferMemory);
-    stbi_image_free(pixels);
 
-    createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageMemory);
-    transitionImageLayout(m_textureImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    copyBufferToImage(stagingBuffer, m_textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-    transitionImageLayout(m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    std::vector<VkBufferImageCopy> regions(header.mipLevels);
+    for (uint32_t level = 0; level < header.mipLevels; level++)
+    {
+        regions.at(level) = VkBufferImageCopy{
+            .bufferOffset = static_cast<VkDeviceSize>(container.level(level).offset - container.level(0).offset),
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = header.layerCount,
+            },
+            .imageOffset = { .x = 0, .y = 0, .z = 0 },
+            .imageExtent = { .width = std::max(header.width >> level, 1u), .height = std::max(header.height >> level, 1u), .depth = 1 },
+        };
+    }
+
+    m_textureMipLevels = header.mipLevels;
+    createImage(header.width, header.height, m_textureMipLevels, header.layerCount, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_textureImage, m_textureImageMemory);
+    transitionImageLayout(m_textureImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_textureMipLevels, header.layerCount);
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+    endSingleTimeCommands(commandBuffer);
+
+    transitionImageLayout(m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_textureMipLevels, header.layerCount);
 
     vkDestroyBuffer(m_device, stagingBuffer, VK_NULL_HANDLE);
-    vkFreeMemory(m_device, stagingBufferMemory, VK_NULL_HANDLE);
+    freeMemory(stagingBufferMemory);
+
+    return true;
+}
+
+/* Expects every level in TRANSFER_DST_OPTIMAL with level 0 filled in, and leaves every level in SHADER_READ_ONLY_OPTIMAL */
+void Renderer::generateMipmaps(VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount)
+{
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+    {
+        throw std::runtime_error("texture image format does not support linear blitting!");
+    }
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+    VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = VK_NULL_HANDLE,
+        .srcAccessMask = 0,
+        .dstAccessMask = 0,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = layerCount,
+        },
+    };
+
+    int32_t mipWidth = static_cast<int32_t>(width);
+    int32_t mipHeight = static_cast<int32_t>(height);
+
+    for (uint32_t level = 1; level < mipLevels; level++)
+    {
+        /* The previous level was just written, it becomes the source of this one */
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            0, VK_NULL_HANDLE,
+            0, VK_NULL_HANDLE,
+            1, &barrier);
+
+        const int32_t nextWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+        const int32_t nextHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+
+        const VkImageBlit blit = {
+            .srcSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level - 1,
+                .baseArrayLayer = 0,
+                .layerCount = layerCount,
+            },
+            .srcOffsets = { { .x = 0, .y = 0, .z = 0 }, { .x = mipWidth, .y = mipHeight, .z = 1 } },
+            .dstSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = layerCount,
+            },
+            .dstOffsets = { { .x = 0, .y = 0, .z = 0 }, { .x = nextWidth, .y = nextHeight, .z = 1 } },
+        };
+
+        vkCmdBlitImage(
+            commandBuffer,
+            image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit,
+            VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            0, VK_NULL_HANDLE,
+            0, VK_NULL_HANDLE,
+            1, &barrier);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+    /* The last level is only ever written */
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0, VK_NULL_HANDLE,
+        0, VK_NULL_HANDLE,
+        1, &barrier);
+
+    endSingleTimeCommands(commandBuffer);
 }
 
 void Renderer::createTextureImageView(void)
 {
-    m_textureImageView = createImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_textureImageView = createImageView(m_textureImage, VK_IMAGE_VIEW_TYPE_2D_ARRAY, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, m_textureMipLevels, static_cast<uint32_t>(BLOCK_TEXTURE_FILES.size()));
 }
 
 void Renderer::createTextureSampler()
@@ -1300,9 +2070,9 @@ void Renderer::createTextureSampler()
         .flags = 0,
         .magFilter = VK_FILTER_LINEAR,
         .minFilter = VK_FILTER_LINEAR,
-        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
-        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT, /* Greedy quads span several blocks, each layer repeats across them */
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
         .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
         .mipLodBias = 0.0f,
         .anisotropyEnable = VK_FALSE,
@@ -1310,7 +2080,7 @@ void Renderer::createTextureSampler()
         .compareEnable = VK_FALSE,
         .compareOp = VK_COMPARE_OP_ALWAYS,
         .minLod = 0.0f,
-        .maxLod = 0.0f,
+        .maxLod = static_cast<float>(m_textureMipLevels),
         .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
         .unnormalizedCoordinates = VK_FALSE,
     };
@@ -1321,12 +2091,6 @@ void Renderer::createTextureSampler()
     }
 }
 
-void Renderer::loadModel(const World &world)
-{
-    m_vertices = world.vertices;
-    m_indices = world.indices;
-}
-
 uint32_t Renderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
 {
     VkPhysicalDeviceMemoryProperties memProperties;
@@ -1364,17 +2128,22 @@ void Renderer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemor
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(m_device, buffer, &memRequirements);
 
+    /* Buffers read through their device address need memory allocated with that capability */
+    const VkMemoryAllocateFlagsInfo allocFlagsInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .pNext = VK_NULL_HANDLE,
+        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+        .deviceMask = 0,
+    };
+
     const VkMemoryAllocateInfo allocInfo = {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = VK_NULL_HANDLE,
+        .pNext = (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) != 0 ? &allocFlagsInfo : VK_NULL_HANDLE,
         .allocationSize = memRequirements.size,
         .memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties),
     };
 
-    if (vkAllocateMemory(m_device, &allocInfo, VK_NULL_HANDLE, &bufferMemory) != VK_SUCCESS)
-    {
-        throw std::runtime_error("vkAllocateMemory() failed!");
-    }
+    bufferMemory = allocateMemory(allocInfo, AllocationKind::Buffer);
 
     if (vkBindBufferMemory(m_device, buffer, bufferMemory, 0) != VK_SUCCESS)
     {
@@ -1382,167 +2151,191 @@ void Renderer::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemor
     }
 }
 
-void Renderer::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkDeviceSize &size)
+VkDeviceMemory Renderer::allocateMemory(const VkMemoryAllocateInfo &allocInfo, const AllocationKind kind)
 {
-    const VkCommandBufferAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = VK_NULL_HANDLE,
-        .commandPool = m_cmdPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
-    };
-
-    VkCommandBuffer cmdBuffer;
-    if (vkAllocateCommandBuffers(m_device, &allocInfo, &cmdBuffer) != VK_SUCCESS)
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (vkAllocateMemory(m_device, &allocInfo, VK_NULL_HANDLE, &memory) != VK_SUCCESS)
     {
-        throw std::runtime_error("vkAllocateCommandBuffers() failed!");
+        throw std::runtime_error("vkAllocateMemory() failed!");
     }
 
-    constexpr VkCommandBufferBeginInfo beginInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .pNext = VK_NULL_HANDLE,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-        .pInheritanceInfo = VK_NULL_HANDLE,
-    };
+    MemoryStats::MemoryType &type = m_memoryTypeStats.at(allocInfo.memoryTypeIndex);
+    type.allocationCount++;
+    (kind == AllocationKind::Buffer ? type.bufferBytes : type.imageBytes) += allocInfo.allocationSize;
+    type.peakBytes = std::max(type.peakBytes, type.bufferBytes + type.imageBytes);
+
+    m_allocatedBytes += allocInfo.allocationSize;
+    m_peakAllocatedBytes = std::max(m_peakAllocatedBytes, m_allocatedBytes);
 
-    if (vkBeginCommandBuffer(cmdBuffer, &beginInfo) != VK_SUCCESS)
+    m_allocations.emplace(memory, TrackedAllocation{ .memoryType = allocInfo.memoryTypeIndex, .size = allocInfo.allocationSize, .kind = kind });
+    return memory;
+}
+
+void Renderer::freeMemory(VkDeviceMemory &memory)
+{
+    if (memory == VK_NULL_HANDLE)
     {
-        throw std::runtime_error("vkBeginCommandBuffer() failed!");
+        return;
     }
 
-    const VkBufferCopy copyRegion = {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size = size,
-    };
-    vkCmdCopyBuffer(cmdBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-    if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS)
+    const auto allocation = m_allocations.find(memory);
+    if (allocation != m_allocations.end())
     {
-        throw std::runtime_error("vkEndCommandBuffer() failed!");
+        MemoryStats::MemoryType &type = m_memoryTypeStats.at(allocation->second.memoryType);
+        type.allocationCount--;
+        (allocation->second.kind == AllocationKind::Buffer ? type.bufferBytes : type.imageBytes) -= allocation->second.size;
+        m_allocatedBytes -= allocation->second.size;
+        m_allocations.erase(allocation);
     }
 
-    const VkSubmitInfo submitInfo = {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .pNext = VK_NULL_HANDLE,
-        .waitSemaphoreCount = 0,
-        .pWaitSemaphores = VK_NULL_HANDLE,
-        .pWaitDstStageMask = VK_NULL_HANDLE,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &cmdBuffer,
-        .signalSemaphoreCount = 0,
-        .pSignalSemaphores = VK_NULL_HANDLE,
-    };
+    vkFreeMemory(m_device, memory, VK_NULL_HANDLE);
+    memory = VK_NULL_HANDLE;
+}
 
-    vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(m_graphicsQueue);
-    vkFreeCommandBuffers(m_device, m_cmdPool, 1, &cmdBuffer);
+void Renderer::destroyBuffer(GpuBuffer &buffer)
+{
+    if (buffer.buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_device, buffer.buffer, VK_NULL_HANDLE);
+        buffer.buffer = VK_NULL_HANDLE;
+    }
+
+    if (buffer.memory != VK_NULL_HANDLE)
+    {
+        freeMemory(buffer.memory);
+    }
 }
 
 void Renderer::destroyGeometryBuffers(void)
 {
-    if (m_vertexBuffer != VK_NULL_HANDLE)
+    for (auto &[coord, geometry] : m_chunkGeometry)
     {
-        vkDestroyBuffer(m_device, m_vertexBuffer, VK_NULL_HANDLE);
-        m_vertexBuffer = VK_NULL_HANDLE;
+        destroyBuffer(geometry.buffer);
     }
+    m_chunkGeometry.clear();
+    m_chunkGeometryBytes = 0;
+    m_evictedGeometry.clear();
 
-    if (m_indexBuffer != VK_NULL_HANDLE)
+    for (PendingUpload &upload : m_pendingUploads)
     {
-        vkDestroyBuffer(m_device, m_indexBuffer, VK_NULL_HANDLE);
-        m_indexBuffer = VK_NULL_HANDLE;
+        destroyBuffer(upload.staging);
     }
+    m_pendingUploads.clear();
 
-    if (m_vertexBufferMemory != VK_NULL_HANDLE)
+    for (GpuBuffer &buffer : m_pendingRetirements)
     {
-        vkFreeMemory(m_device, m_vertexBufferMemory, VK_NULL_HANDLE);
-        m_vertexBufferMemory = VK_NULL_HANDLE;
+        destroyBuffer(buffer);
     }
+    m_pendingRetirements.clear();
 
-    if (m_indexBufferMemory != VK_NULL_HANDLE)
+    for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++)
     {
-        vkFreeMemory(m_device, m_indexBufferMemory, VK_NULL_HANDLE);
-        m_indexBufferMemory = VK_NULL_HANDLE;
+        releaseRetiredBuffers(frame);
     }
 }
 
-void Renderer::createVertexBuffer(void)
+void Renderer::createQuadIndexBuffer(void)
 {
-    if (m_vertices.empty())
+    std::vector<uint32_t> indices(static_cast<size_t>(ChunkMesh::MAX_QUADS) * ChunkMesh::INDICES_PER_QUAD);
+    for (uint32_t quad = 0; quad < ChunkMesh::MAX_QUADS; quad++)
     {
-        return;
+        const uint32_t baseVertex = quad * ChunkMesh::VERTICES_PER_QUAD;
+        const size_t baseIndex = static_cast<size_t>(quad) * ChunkMesh::INDICES_PER_QUAD;
+
+        indices[baseIndex + 0] = baseVertex + 0;
+        indices[baseIndex + 1] = baseVertex + 1;
+        indices[baseIndex + 2] = baseVertex + 2;
+        indices[baseIndex + 3] = baseVertex + 2;
+        indices[baseIndex + 4] = baseVertex + 3;
+        indices[baseIndex + 5] = baseVertex + 0;
     }
 
-    const VkDeviceSize bufferSize = sizeof(m_vertices.at(0)) * m_vertices.size();
+    const VkDeviceSize bufferSize = sizeof(uint32_t) * indices.size();
 
-    VkBuffer stagingBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    GpuBuffer staging{};
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging.buffer, staging.memory);
 
     void *data = VK_NULL_HANDLE;
-    vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, m_vertices.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(m_device, stagingBufferMemory);
+    vkMapMemory(m_device, staging.memory, 0, bufferSize, 0, &data);
+    memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
+    vkUnmapMemory(m_device, staging.memory);
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexBuffer, m_vertexBufferMemory);
-    copyBuffer(stagingBuffer, m_vertexBuffer, bufferSize);
+    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_quadIndexBuffer.buffer, m_quadIndexBuffer.memory);
 
-    vkDestroyBuffer(m_device, stagingBuffer, VK_NULL_HANDLE);
-    vkFreeMemory(m_device, stagingBufferMemory, VK_NULL_HANDLE);
+    VkCommandBuffer cmdBuffer = beginSingleTimeCommands();
+    const VkBufferCopy copyRegion = {
+        .srcOffset = 0,
+        .dstOffset = 0,
+        .size = bufferSize,
+    };
+    vkCmdCopyBuffer(cmdBuffer, staging.buffer, m_quadIndexBuffer.buffer, 1, &copyRegion);
+    endSingleTimeCommands(cmdBuffer);
+
+    destroyBuffer(staging);
 }
 
-void Renderer::createIndexBuffer(void)
+void Renderer::recordPendingUploads(VkCommandBuffer cmdBuffer)
 {
-    if (m_indices.empty())
+    if (m_pendingUploads.empty())
     {
         return;
     }
 
-    const VkDeviceSize bufferSize = sizeof(m_indices.at(0)) * m_indices.size();
+    for (PendingUpload &upload : m_pendingUploads)
+    {
+        const VkBufferCopy copyRegion = {
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = upload.size,
+        };
+        vkCmdCopyBuffer(cmdBuffer, upload.staging.buffer, upload.destination, 1, &copyRegion);
 
-    VkBuffer stagingBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+        m_pendingRetirements.push_back(upload.staging);
+    }
+    m_pendingUploads.clear();
 
-    void *data = VK_NULL_HANDLE;
-    vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, m_indices.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(m_device, stagingBufferMemory);
+    const VkMemoryBarrier2 barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .pNext = VK_NULL_HANDLE,
+        .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+        .dstAccessMask = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+    };
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_indexBuffer, m_indexBufferMemory);
-    copyBuffer(stagingBuffer, m_indexBuffer, bufferSize);
+    const VkDependencyInfo dependencyInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext = VK_NULL_HANDLE,
+        .dependencyFlags = {},
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &barrier,
+        .bufferMemoryBarrierCount = 0,
+        .pBufferMemoryBarriers = VK_NULL_HANDLE,
+        .imageMemoryBarrierCount = 0,
+        .pImageMemoryBarriers = VK_NULL_HANDLE,
+    };
 
-    vkDestroyBuffer(m_device, stagingBuffer, VK_NULL_HANDLE);
-    vkFreeMemory(m_device, stagingBufferMemory, VK_NULL_HANDLE);
+    vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
 }
 
-void Renderer::createUniformBuffers(void)
+void Renderer::releaseRetiredBuffers(uint32_t frame)
 {
-    m_uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    m_uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    m_uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
-
-    constexpr VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-    for (uint8_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (GpuBuffer &buffer : m_retiredBuffers.at(frame))
     {
-        createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_uniformBuffers.at(i), m_uniformBuffersMemory.at(i));
-        vkMapMemory(m_device, m_uniformBuffersMemory.at(i), 0, bufferSize, 0, &m_uniformBuffersMapped.at(i));
+        destroyBuffer(buffer);
     }
+
+    m_retiredBuffers.at(frame).clear();
 }
 
 void Renderer::createDescriptorPool(void)
 {
-    constexpr VkDescriptorPoolSize uboPool = {
-        .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-        .descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
-    };
-
     constexpr VkDescriptorPoolSize samplerPool = {
         .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
         .descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
     };
 
-    constexpr std::array<VkDescriptorPoolSize, 2> poolSizes = { uboPool, samplerPool };
+    constexpr std::array<VkDescriptorPoolSize, 1> poolSizes = { samplerPool };
     const VkDescriptorPoolCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .pNext = VK_NULL_HANDLE,
@@ -1578,25 +2371,6 @@ void Renderer::createDescriptorSets(void)
 
     for (uint8_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        const VkDescriptorBufferInfo uboInfo = {
-            .buffer = m_uniformBuffers.at(i),
-            .offset = 0,
-            .range = sizeof(UniformBufferObject),
-        };
-
-        const VkWriteDescriptorSet uboDescriptorSet = {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .pNext = VK_NULL_HANDLE,
-            .dstSet = m_descriptorSets.at(i),
-            .dstBinding = 0,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .pImageInfo = VK_NULL_HANDLE,
-            .pBufferInfo = &uboInfo,
-            .pTexelBufferView = VK_NULL_HANDLE,
-        };
-
         const VkDescriptorImageInfo imageInfo = {
             .sampler = m_textureSampler,
             .imageView = m_textureImageView,
@@ -1607,7 +2381,7 @@ void Renderer::createDescriptorSets(void)
             .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
             .pNext = VK_NULL_HANDLE,
             .dstSet = m_descriptorSets.at(i),
-            .dstBinding = 1,
+            .dstBinding = 0,
             .dstArrayElement = 0,
             .descriptorCount = 1,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
@@ -1616,7 +2390,7 @@ void Renderer::createDescriptorSets(void)
             .pTexelBufferView = VK_NULL_HANDLE,
         };
 
-        const std::array<VkWriteDescriptorSet, 2> descriptorWrites = { uboDescriptorSet, imageDescriptorSet };
+        const std::array<VkWriteDescriptorSet, 1> descriptorWrites = { imageDescriptorSet };
         vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, VK_NULL_HANDLE);
     }
 }
@@ -1688,6 +2462,8 @@ void Renderer::transition_image_layout(
 
 void Renderer::recordCommandBuffer(uint32_t imageIndex)
 {
+    const CpuProfiler::Zone zone("Renderer::recordCommandBuffer");
+
     VkCommandBuffer cmdBuffer = m_cmdBuffers.at(m_currentFrame);
 
     const VkCommandBufferBeginInfo beginInfo = {
@@ -1699,6 +2475,14 @@ void Renderer::recordCommandBuffer(uint32_t imageIndex)
 
     vkBeginCommandBuffer(cmdBuffer, &beginInfo);
 
+    /* This frame's fence was waited on before recording, so its previous timestamps are ready to be read */
+    m_gpuProfiler.beginFrame(cmdBuffer, m_currentFrame);
+
+    {
+        const GpuProfiler::Scope uploadScope(m_gpuProfiler, cmdBuffer, "uploads");
+        recordPendingUploads(cmdBuffer);
+    }
+
     transition_image_layout(
         m_swapChainImages.at(imageIndex),
         VK_IMAGE_LAYOUT_UNDEFINED,
@@ -1736,8 +2520,8 @@ void Renderer::recordCommandBuffer(uint32_t imageIndex)
         .clearValue = clearColor,
     };
 
-    constexpr VkClearValue clearDepth = {
-        .depthStencil = { .depth = 1.0f, .stencil = 0 },
+    const VkClearValue clearDepth = {
+        .depthStencil = { .depth = m_settings.depthMode == DepthMode::ReverseInfinite ? 0.0f : 1.0f, .stencil = 0 },
     };
 
     const VkRenderingAttachmentInfo depthAttachment = {
@@ -1769,6 +2553,7 @@ void Renderer::recordCommandBuffer(uint32_t imageIndex)
         .pStencilAttachment = VK_NULL_HANDLE,
     };
 
+    const uint32_t chunkScope = m_gpuProfiler.beginScope(cmdBuffer, "chunks");
     vkCmdBeginRendering(cmdBuffer, &renderingInfo);
     vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
     vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets.at(m_currentFrame), 0, VK_NULL_HANDLE);
@@ -1789,26 +2574,88 @@ void Renderer::recordCommandBuffer(uint32_t imageIndex)
     };
     vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 
-    if (!m_indices.empty() && m_vertexBuffer != VK_NULL_HANDLE && m_indexBuffer != VK_NULL_HANDLE)
+    /* Split the camera position so the subtraction below happens in integers and only the small remainder is a float */
+    const glm::ivec3 cameraBlock{
+        static_cast<int32_t>(std::floor(m_cameraPosition.x)),
+        static_cast<int32_t>(std::floor(m_cameraPosition.y)),
+        static_cast<int32_t>(std::floor(m_cameraPosition.z)),
+    };
+    const glm::vec3 cameraFraction = m_cameraPosition - glm::vec3(cameraBlock);
+
+    vkCmdBindIndexBuffer(cmdBuffer, m_quadIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+    /* Push constants keep their contents between draws, so the camera goes in once and each chunk only replaces its own part */
+    PushConstants pushConstants{};
+    pushConstants.viewProjection = m_viewProjection;
+    vkCmdPushConstants(cmdBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), &pushConstants);
+
+    for (const auto &[coord, geometry] : m_chunkGeometry)
     {
-        VkDeviceSize offset = 0;
-        vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &m_vertexBuffer, &offset);
-        vkCmdBindIndexBuffer(cmdBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-        vkCmdDrawIndexed(cmdBuffer, static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0);
+        const glm::ivec3 chunkOrigin{
+            coord.x * static_cast<int32_t>(World::CHUNK_WIDTH),
+            0,
+            coord.z * static_cast<int32_t>(World::CHUNK_DEPTH),
+        };
+
+        pushConstants.chunkOffset = glm::vec4(glm::vec3(chunkOrigin - cameraBlock) - cameraFraction, 0.0f);
+        pushConstants.quadAddress = geometry.quadAddress;
+        vkCmdPushConstants(cmdBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, CHUNK_PUSH_CONSTANTS_OFFSET, CHUNK_PUSH_CONSTANTS_SIZE, &pushConstants.chunkOffset);
+
+        if (m_settings.geometryMode == GeometryMode::VertexAttributes)
+        {
+            constexpr VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &geometry.buffer.buffer, &offset);
+        }
+
+        /* A face can only be seen from in front of its plane and every plane lies within the chunk's bounds, so a camera
+           past one side of the chunk sees none of the faces pointing the other way. Neighbouring visible directions are
+           contiguous in the buffer and share a draw */
+        const glm::vec3 cameraLocal = -glm::vec3(pushConstants.chunkOffset);
+        const std::array<bool, ChunkMesh::FACE_DIRECTION_COUNT> directionVisible = {
+            cameraLocal.x > 0.0f, cameraLocal.x < static_cast<float>(World::CHUNK_WIDTH),
+            cameraLocal.y > 0.0f, cameraLocal.y < static_cast<float>(World::CHUNK_HEIGHT),
+            cameraLocal.z > 0.0f, cameraLocal.z < static_cast<float>(World::CHUNK_DEPTH),
+        };
+
+        uint32_t direction = 0;
+        while (direction < ChunkMesh::FACE_DIRECTION_COUNT)
+        {
+            if (!directionVisible.at(direction))
+            {
+                direction++;
+                continue;
+            }
+
+            const uint32_t firstQuad = geometry.directionOffsets.at(direction);
+            while (direction < ChunkMesh::FACE_DIRECTION_COUNT && directionVisible.at(direction))
+            {
+                direction++;
+            }
+
+            const uint32_t quadCount = geometry.directionOffsets.at(direction) - firstQuad;
+            if (quadCount > 0)
+            {
+                vkCmdDrawIndexed(cmdBuffer, quadCount * ChunkMesh::INDICES_PER_QUAD, 1, firstQuad * ChunkMesh::INDICES_PER_QUAD, 0, 0);
+            }
+        }
     }
 
     vkCmdEndRendering(cmdBuffer);
+    m_gpuProfiler.endScope(cmdBuffer, chunkScope);
 
+    /* Offscreen images are left ready to be copied out by captureFrame() */
     transition_image_layout(
         m_swapChainImages.at(imageIndex),
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
         VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        {},
+        m_headless ? VK_ACCESS_2_TRANSFER_READ_BIT : VkAccessFlags2{},
         VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+        m_headless ? VK_PIPELINE_STAGE_2_TRANSFER_BIT : VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
         VK_IMAGE_ASPECT_COLOR_BIT);
 
+    m_gpuProfiler.endFrame(cmdBuffer);
+
     if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS)
     {
         throw std::runtime_error("vkEndCommandBuffer() failed!");
@@ -2,11 +2,15 @@
 
 #include <SDL3/SDL_video.h>
 #include <volk/volk.h>
+#include <array>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "camera/camera.hpp"
+#include "renderer/gpu_profiler.hpp"
 #include "renderer/voxel.hpp"
 #include "world/world.hpp"
 
@@ -18,25 +22,147 @@ public:
         uint32_t graphicsFamily = UINT32_MAX;
         uint32_t presentFamily = UINT32_MAX;
 
-        [[nodiscard]] bool isComplete(void) const
+        [[nodiscard]] bool isComplete(bool needsPresent) const
         {
-            return graphicsFamily != UINT32_MAX && presentFamily != UINT32_MAX;
+            return graphicsFamily != UINT32_MAX && (!needsPresent || presentFamily != UINT32_MAX);
         }
     };
 
-    void init(SDL_Window *window, const World &world);
+    /* How chunk geometry reaches the vertex shader */
+    enum class GeometryMode : uint8_t
+    {
+        VertexAttributes, /* Quads are expanded into four Voxel vertices on upload */
+        QuadPulling,      /* The 8 byte quads are uploaded as they are and expanded by the vertex shader */
+    };
+
+    /* How depth is mapped and tested */
+    enum class DepthMode : uint8_t
+    {
+        Standard,        /* Depth grows towards the far plane, cleared to 1, LESS test */
+        ReverseInfinite, /* Depth shrinks towards an infinitely far plane, cleared to 0, GREATER test, 32-bit float depth */
+    };
+
+    struct Settings
+    {
+        GeometryMode geometryMode = GeometryMode::QuadPulling;
+        DepthMode depthMode = DepthMode::ReverseInfinite;
+        double gpuProfilerLogSeconds = 5.0; /* How often the GPU timings are printed, 0 keeps them quiet */
+        VkDeviceSize geometryBudgetBytes = 0; /* Cap on the chunk geometry in device memory, 0 for none */
+        uint32_t geometryViewRadius = 16;     /* In chunks around the camera, geometry in here is never dropped. Keep it within the world's resident radius */
+    };
+
+    struct PipelineCacheStats
+    {
+        bool loadedFromDisk = false;               /* A cache written for this exact device and driver was found */
+        size_t loadedBytes = 0;
+        size_t savedBytes = 0;
+        double pipelineCreationMilliseconds = 0.0; /* Time spent in vkCreateGraphicsPipelines() so far */
+    };
+
+    /* Totals since init, for benchmarks and replays */
+    struct UploadStats
+    {
+        uint64_t chunkMeshes = 0; /* Meshes passed to updateChunkMesh(), empty ones included */
+        uint64_t bytes = 0;       /* Geometry bytes staged for the GPU */
+    };
+
+    /* Device memory the renderer has allocated per memory type, next to what the driver reports per heap */
+    struct MemoryStats
+    {
+        struct MemoryType
+        {
+            VkMemoryPropertyFlags flags = 0;
+            uint32_t heapIndex = 0;
+            uint32_t allocationCount = 0;
+            VkDeviceSize bufferBytes = 0;
+            VkDeviceSize imageBytes = 0;
+            VkDeviceSize peakBytes = 0; /* Buffers and images together */
+        };
+
+        struct MemoryHeap
+        {
+            VkMemoryHeapFlags flags = 0;
+            VkDeviceSize size = 0;
+            VkDeviceSize budget = 0; /* What the process can allocate from the heap before trouble, 0 without VK_EXT_memory_budget */
+            VkDeviceSize usage = 0;  /* By the whole process, the driver's own allocations included. 0 without VK_EXT_memory_budget */
+        };
+
+        std::vector<MemoryType> types{};
+        std::vector<MemoryHeap> heaps{};
+        VkDeviceSize allocatedBytes = 0;
+        VkDeviceSize peakAllocatedBytes = 0;
+        bool budgetAvailable = false;
+        VkDeviceSize chunkGeometryBytes = 0;
+        size_t evictedGeometryCount = 0;
+    };
+
+    /* A frame read back from the GPU: tightly packed RGBA8 (sRGB) rows, top row first */
+    struct FrameCapture
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels{};
+    };
+
+    void init(SDL_Window *window, const Settings &settings = {});
+
+    /* Renders into offscreen images of a fixed size instead of a swap chain - no window, surface or present queue, so it runs
+       without a display (and on lavapipe without a GPU) */
+    void initHeadless(uint32_t width, uint32_t height, const Settings &settings = {});
     void cleanup(void);
 
     void drawFrame(void);
-    void updateWorldMesh(World::Mesh mesh);
-    void updateUniformBuffer(const Camera &camera);
+    void updateChunkMesh(World::Mesh mesh);
+
+    /* Over the geometry budget, drops the geometry of the chunks farthest from the camera outside of the view radius until it fits.
+       Dropped chunks that are back within the radius are added to restore, for the world to mesh them again. Call once per frame */
+    void updateGeometryResidency(std::vector<ChunkCoord> &restore);
+    void updateCamera(const Camera &camera);
     void setFramebufferResized(bool resized);
     void waitIdle(void) const;
 
+    [[nodiscard]] const PipelineCacheStats &pipelineCacheStats(void) const;
+    [[nodiscard]] const GpuProfiler &gpuProfiler(void) const;
+    [[nodiscard]] const UploadStats &uploadStats(void) const;
+    [[nodiscard]] MemoryStats memoryStats(void) const;
+    [[nodiscard]] bool headless(void) const;
+
+    /* Headless only: waits for the most recently drawn frame and copies it back */
+    [[nodiscard]] FrameCapture captureFrame(void);
+    void saveFrame(const std::string &path);
+
 private:
     static constexpr uint8_t MAX_FRAMES_IN_FLIGHT = 2;
 
+    struct GpuBuffer
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+    };
+
+    /* Vertices or quads (depending on the geometry mode) in a device-local buffer, drawn through the shared quad index buffer */
+    struct ChunkGeometry
+    {
+        GpuBuffer buffer{};
+        VkDeviceSize size = 0;
+        VkDeviceAddress quadAddress = 0;
+        uint32_t quadCount = 0;
+        std::array<uint32_t, ChunkMesh::FACE_DIRECTION_COUNT + 1> directionOffsets{};
+    };
+
+    struct PendingUpload
+    {
+        GpuBuffer staging{};
+        VkBuffer destination = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+    };
+
     SDL_Window *m_window = nullptr;
+    Settings m_settings{};
+    bool m_headless = false;
+
+    /* Everything from picking the GPU onwards, shared by both init paths */
+    void createDeviceObjects(void);
 
     void loadVulkan(void);    
     
@@ -68,10 +194,21 @@ private:
     VkExtent2D m_swapChainExtent{};
     std::vector<VkImage> m_swapChainImages{};
 
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+    /* Headless stand-in for the swap chain: one image per frame in flight, kept in m_swapChainImages */
+    void createOffscreenImages(void);
+    std::vector<VkDeviceMemory> m_offscreenImageMemory{};
+    uint32_t m_lastImageIndex = UINT32_MAX;
+
+    VkImageView createImageView(VkImage image, VkImageViewType viewType, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, uint32_t layerCount);
     void createImageViews(void);
     std::vector<VkImageView> m_swapChainImageViews{};
 
+    /* Loaded from and saved to PIPELINE_CACHE_FILE, a cache from another device or driver is thrown away */
+    void createPipelineCache(void);
+    void savePipelineCache(void);
+    VkPipelineCache m_pipelineCache{ VK_NULL_HANDLE };
+    PipelineCacheStats m_pipelineCacheStats{};
+
     void createDescriptorSetLayout(void);
     VkDescriptorSetLayout m_descriptorSetLayout{ VK_NULL_HANDLE };
     
@@ -92,12 +229,18 @@ private:
     VkDeviceMemory m_depthImageMemory{ VK_NULL_HANDLE };
     VkImageView m_depthImageView{ VK_NULL_HANDLE };
 
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory);
-    void transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout);
-    void copyBufferToImage(VkBuffer srcBuffer, VkImage image, uint32_t width, uint32_t height);
+    void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory);
+    void transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount);
+    void copyBufferToImage(VkBuffer srcBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
+    void generateMipmaps(VkImage image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount);
+
+    /* One layer per BlockTexture, each with a full mip chain. Loaded from the baked container when there is an up to date one,
+       otherwise the PNGs are decoded and the mips are blitted on the GPU */
     void createTextureImage(void);
+    [[nodiscard]] bool createBakedTextureImage(void);
     VkImage m_textureImage{ VK_NULL_HANDLE };
     VkDeviceMemory m_textureImageMemory{ VK_NULL_HANDLE };
+    uint32_t m_textureMipLevels = 1;
 
     void createTextureImageView(void);
     VkImageView m_textureImageView{ VK_NULL_HANDLE };
@@ -107,28 +250,53 @@ private:
 
     VkCommandBuffer beginSingleTimeCommands(void);
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-   
-    void loadModel(const World &world);
-    std::vector<Voxel> m_vertices;
-    std::vector<uint32_t> m_indices;
 
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+    enum class AllocationKind : uint8_t
+    {
+        Buffer,
+        Image
+    };
+
+    struct TrackedAllocation
+    {
+        uint32_t memoryType = 0;
+        VkDeviceSize size = 0;
+        AllocationKind kind = AllocationKind::Buffer;
+    };
+
+    /* Every device allocation goes through these two, which keep m_memoryTypeStats up to date */
+    [[nodiscard]] VkDeviceMemory allocateMemory(const VkMemoryAllocateInfo &allocInfo, AllocationKind kind);
+    void freeMemory(VkDeviceMemory &memory);
+    std::unordered_map<VkDeviceMemory, TrackedAllocation> m_allocations{};
+    std::vector<MemoryStats::MemoryType> m_memoryTypeStats{};
+    VkDeviceSize m_allocatedBytes = 0;
+    VkDeviceSize m_peakAllocatedBytes = 0;
+    bool m_memoryBudgetSupported = false;
+
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory);
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkDeviceSize &size);
+    void destroyBuffer(GpuBuffer &buffer);
     void destroyGeometryBuffers(void);
-    
-    void createVertexBuffer(void);
-    VkBuffer m_vertexBuffer{ VK_NULL_HANDLE };
-    VkDeviceMemory m_vertexBufferMemory{ VK_NULL_HANDLE };
 
-    void createIndexBuffer(void);
-    VkDeviceMemory m_indexBufferMemory{ VK_NULL_HANDLE };
-    VkBuffer m_indexBuffer{ VK_NULL_HANDLE };
+    /* (0, 1, 2, 2, 3, 0) for every quad a chunk can possibly have, built once and shared by every chunk draw */
+    void createQuadIndexBuffer(void);
+    GpuBuffer m_quadIndexBuffer{};
+
+    /* Buffers replaced or consumed by a frame are only destroyed once that frame's fence has signaled */
+    void recordPendingUploads(VkCommandBuffer cmdBuffer);
+    void releaseRetiredBuffers(uint32_t frame);
+    std::unordered_map<ChunkCoord, ChunkGeometry> m_chunkGeometry{};
+    VkDeviceSize m_chunkGeometryBytes = 0;
+    std::unordered_set<ChunkCoord> m_evictedGeometry{};
+    std::vector<PendingUpload> m_pendingUploads{};
+    std::vector<GpuBuffer> m_pendingRetirements{};
+    std::array<std::vector<GpuBuffer>, MAX_FRAMES_IN_FLIGHT> m_retiredBuffers{};
+    UploadStats m_uploadStats{};
     
-    void createUniformBuffers(void);
-    std::vector<VkBuffer> m_uniformBuffers;
-    std::vector<VkDeviceMemory> m_uniformBuffersMemory;
-    std::vector<void *> m_uniformBuffersMapped;
+    /* Chunks are drawn relative to the camera so world positions never have to fit in a float */
+    glm::vec3 m_cameraPosition{ 0.0f };
+    glm::mat4 m_viewProjection{ 1.0f };
 
     void createDescriptorPool(void);
     VkDescriptorPool m_descriptorPool{ VK_NULL_HANDLE };
@@ -138,6 +306,9 @@ private:
 
     void createCommandBuffers(void);
     std::vector<VkCommandBuffer> m_cmdBuffers{};
+
+    /* Times the uploads and the chunk pass of every frame, see GpuProfiler */
+    GpuProfiler m_gpuProfiler{};
     
     void recordCommandBuffer(uint32_t imageIndex);
     void transition_image_layout(
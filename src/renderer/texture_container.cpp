@@ -0,0 +1,215 @@
+#include "renderer/texture_container.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedTextureContainer::~MappedTextureContainer()
+{
+    close();
+}
+
+bool MappedTextureContainer::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const std::byte *>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat{};
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    /* The mapping keeps the file alive on its own */
+    void *view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_data = static_cast<const std::byte *>(view);
+    m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+    if (!validate())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedTextureContainer::close(void)
+{
+    if (m_data == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    CloseHandle(static_cast<HANDLE>(m_file));
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    munmap(const_cast<std::byte *>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_header = TextureContainerHeader{};
+}
+
+const TextureContainerHeader &MappedTextureContainer::header(void) const
+{
+    return m_header;
+}
+
+TextureContainerLevel MappedTextureContainer::level(const uint32_t mipLevel) const
+{
+    if (mipLevel >= m_header.mipLevels)
+    {
+        throw std::out_of_range("texture container has no such mip level!");
+    }
+
+    TextureContainerLevel level{};
+    std::memcpy(&level, m_data + sizeof(TextureContainerHeader) + sizeof(TextureContainerLevel) * mipLevel, sizeof(level));
+    return level;
+}
+
+std::span<const std::byte> MappedTextureContainer::texels(void) const
+{
+    const uint64_t begin = level(0).offset;
+    return std::span<const std::byte>(m_data + begin, m_size - static_cast<size_t>(begin));
+}
+
+bool MappedTextureContainer::validate(void)
+{
+    if (m_size < sizeof(TextureContainerHeader))
+    {
+        return false;
+    }
+
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    if (m_header.magic != TextureContainerHeader::MAGIC || m_header.version != TextureContainerHeader::VERSION ||
+        m_header.width == 0 || m_header.height == 0 || m_header.layerCount == 0 || m_header.mipLevels == 0 || m_header.mipLevels > 32)
+    {
+        return false;
+    }
+
+    if (m_size < sizeof(TextureContainerHeader) + sizeof(TextureContainerLevel) * m_header.mipLevels)
+    {
+        return false;
+    }
+
+    /* Levels have to be tightly packed RGBA8, in order, and inside of the file */
+    uint64_t expectedOffset = sizeof(TextureContainerHeader) + sizeof(TextureContainerLevel) * m_header.mipLevels;
+    for (uint32_t mipLevel = 0; mipLevel < m_header.mipLevels; mipLevel++)
+    {
+        const uint64_t levelWidth = std::max(m_header.width >> mipLevel, 1u);
+        const uint64_t levelHeight = std::max(m_header.height >> mipLevel, 1u);
+        const TextureContainerLevel entry = level(mipLevel);
+
+        if (entry.offset != expectedOffset || entry.size != levelWidth * levelHeight * 4 * m_header.layerCount || entry.offset + entry.size > m_size)
+        {
+            return false;
+        }
+
+        expectedOffset += entry.size;
+    }
+
+    return true;
+}
+
+void writeTextureContainer(const std::string &path, const uint32_t width, const uint32_t height, const uint32_t layerCount, std::span<const TextureContainerLevelData> levels)
+{
+    const TextureContainerHeader header{
+        .magic = TextureContainerHeader::MAGIC,
+        .version = TextureContainerHeader::VERSION,
+        .width = width,
+        .height = height,
+        .layerCount = layerCount,
+        .mipLevels = static_cast<uint32_t>(levels.size()),
+    };
+
+    std::vector<TextureContainerLevel> entries(levels.size());
+    uint64_t offset = sizeof(TextureContainerHeader) + sizeof(TextureContainerLevel) * levels.size();
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        entries[i] = TextureContainerLevel{ .offset = offset, .size = levels[i].size() };
+        offset += levels[i].size();
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open " + path + " for writing!");
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(sizeof(TextureContainerLevel) * entries.size()));
+    for (const TextureContainerLevelData &level : levels)
+    {
+        file.write(reinterpret_cast<const char *>(level.data()), static_cast<std::streamsize>(level.size()));
+    }
+
+    if (!file)
+    {
+        throw std::runtime_error("failed to write " + path + "!");
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/* Baked texture array: the header, one TextureContainerLevel per mip level, then the texels of every level with all of its
+   layers back to back. Texels are tightly packed RGBA8 sRGB, so each level can be copied into an image as it is */
+struct TextureContainerHeader
+{
+    static constexpr uint32_t MAGIC = 0x58545856; /* "VXTX" */
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t layerCount = 0;
+    uint32_t mipLevels = 0;
+};
+
+struct TextureContainerLevel
+{
+    uint64_t offset = 0; /* From the start of the file */
+    uint64_t size = 0;
+};
+
+static_assert(sizeof(TextureContainerHeader) == 24 && sizeof(TextureContainerLevel) == 16, "the container layout is written to disk as it is");
+
+/* Read-only view of a container file mapped into memory, the texels are never copied until they go into a staging buffer */
+class MappedTextureContainer
+{
+public:
+    MappedTextureContainer() = default;
+    ~MappedTextureContainer();
+
+    MappedTextureContainer(const MappedTextureContainer &) = delete;
+    MappedTextureContainer &operator=(const MappedTextureContainer &) = delete;
+    MappedTextureContainer(MappedTextureContainer &&) = delete;
+    MappedTextureContainer &operator=(MappedTextureContainer &&) = delete;
+
+    /* Returns false if the file can't be mapped or isn't a valid container */
+    [[nodiscard]] bool open(const std::string &path);
+    void close(void);
+
+    [[nodiscard]] const TextureContainerHeader &header(void) const;
+    [[nodiscard]] TextureContainerLevel level(const uint32_t mipLevel) const;
+
+    /* Every level's texels, starting at the first level */
+    [[nodiscard]] std::span<const std::byte> texels(void) const;
+
+private:
+    [[nodiscard]] bool validate(void);
+
+    const std::byte *m_data = nullptr;
+    size_t m_size = 0;
+    TextureContainerHeader m_header{};
+
+#ifdef _WIN32
+    void *m_file = nullptr;
+    void *m_mapping = nullptr;
+#endif
+};
+
+/* RGBA8 texels of one mip level, all layers back to back */
+using TextureContainerLevelData = std::vector<uint8_t>;
+
+/* Throws if the file can't be written */
+void writeTextureContainer(const std::string &path, const uint32_t width, const uint32_t height, const uint32_t layerCount, std::span<const TextureContainerLevelData> levels);
@@ -2,16 +2,17 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include <glm/gtx/hash.hpp>
 #include <volk/volk.h>
 #include <array>
 
 struct Voxel
 {
-    glm::vec3 position;
+    glm::u8vec4 position; /* Block corner relative to the chunk origin, w is padding */
     glm::vec3 color;
     glm::vec2 texCoord;
-    glm::vec4 texAtlas;
+    uint32_t textureLayer; /* BlockTexture layer of the block texture array */
 
      /* the number of bytes between data entries and whether to move to the next data entry after each vertex or after each instance */
     constexpr static VkVertexInputBindingDescription getBindingDescription(void)
@@ -33,7 +34,7 @@ struct Voxel
             VkVertexInputAttributeDescription{
                 .location = 0,
                 .binding = 0,
-                .format = VK_FORMAT_R32G32B32_SFLOAT,
+                .format = VK_FORMAT_R8G8B8A8_UINT,
                 .offset = offsetof(Voxel, position),
             },
             
@@ -53,12 +54,12 @@ struct Voxel
                 .offset = offsetof(Voxel, texCoord),
             },
 
-            /* Texture atlas */
+            /* Texture layer */
             VkVertexInputAttributeDescription{
                 .location = 3,
                 .binding = 0,
-                .format = VK_FORMAT_R32G32B32A32_SFLOAT,
-                .offset = offsetof(Voxel, texAtlas),
+                .format = VK_FORMAT_R32_UINT,
+                .offset = offsetof(Voxel, textureLayer),
             }
         }};
 
@@ -71,7 +72,7 @@ struct Voxel
             position == other.position &&
             color == other.color &&
             texCoord == other.texCoord &&
-            texAtlas == other.texAtlas
+            textureLayer == other.textureLayer
         );
     }
 };
@@ -82,10 +83,10 @@ struct std::hash<Voxel>
 	size_t operator()(Voxel const &vertex) const noexcept
 	{
 		return (
-            ((hash<glm::vec3>()(vertex.position) ^
+            ((hash<glm::u8vec4>()(vertex.position) ^
             (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
             (hash<glm::vec2>()(vertex.texCoord) << 1)) ^
-            (hash<glm::vec4>()(vertex.texAtlas) << 1
+            (hash<uint32_t>()(vertex.textureLayer) << 1
         );
 	}
 };
@@ -9,7 +9,60 @@ enum class BlockType : uint8_t
     Sand  = 2,
     Dirt  = 3,
     Stone = 4,
-    Count = 5
+    Lamp  = 5,
+    Count = 6
 };
 
-static constexpr uint8_t BLOCK_TYPE_COUNT = 5;
+static constexpr uint8_t BLOCK_TYPE_COUNT = 6;
+
+/* Layers of the block texture array, in the order the renderer loads them */
+enum class BlockTexture : uint8_t
+{
+    Dirt      = 0,
+    GrassSide = 1,
+    GrassTop  = 2,
+    Sand      = 3,
+    Stone     = 4,
+    Lamp      = 5,
+    Count     = 6
+};
+
+static constexpr uint8_t BLOCK_TEXTURE_COUNT = 6;
+
+/* Texture of one of a block's faces, axis 1 is up. Mirrored by blockFaceTexture() in shader.slang */
+[[nodiscard]] constexpr BlockTexture blockFaceTexture(const BlockType block, const uint32_t axis, const bool isPositive)
+{
+    switch (block)
+    {
+        case BlockType::Grass:
+            if (axis == 1)
+            {
+                return isPositive ? BlockTexture::GrassTop : BlockTexture::Dirt;
+            }
+            return BlockTexture::GrassSide;
+
+        case BlockType::Sand:
+            return BlockTexture::Sand;
+
+        case BlockType::Stone:
+            return BlockTexture::Stone;
+
+        case BlockType::Lamp:
+            return BlockTexture::Lamp;
+
+        default:
+            return BlockTexture::Dirt;
+    }
+}
+
+/* Block light level (0-15) a block gives off */
+[[nodiscard]] constexpr uint8_t blockLightEmission(const BlockType block)
+{
+    return block == BlockType::Lamp ? 14 : 0;
+}
+
+/* Every non-air block is opaque to both sky and block light */
+[[nodiscard]] constexpr bool blocksLight(const BlockType block)
+{
+    return block != BlockType::Air;
+}
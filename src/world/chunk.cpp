@@ -1,11 +1,47 @@
 #include "world/chunk.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
+namespace
+{
+    [[nodiscard]] int32_t floorDiv(const int32_t value, const int32_t divisor)
+    {
+        int32_t result = value / divisor;
+        
+        const int32_t remainder = value % divisor;
+        
+        if (remainder != 0 && ((remainder < 0) != (divisor < 0)))
+        {
+            --result;
+        }
+
+        return result;
+    }
+}
+
+/* The value-initialised arrays are already all air and unlit */
 Chunk::Chunk(ChunkCoord coord)
     : m_coord(coord)
 {
-    m_blocks.fill(BlockType::Air);
+}
+
+void Chunk::reset(ChunkCoord coord)
+{
+    const size_t sectionSize = static_cast<size_t>(WIDTH) * DEPTH * SECTION_HEIGHT;
+    for (uint32_t section = 0; section < SECTION_COUNT; section++)
+    {
+        if (m_sectionBlockCounts[section] != 0)
+        {
+            std::fill_n(m_blocks.begin() + static_cast<std::ptrdiff_t>(section * sectionSize), sectionSize, BlockType::Air);
+        }
+    }
+
+    m_coord = coord;
+    m_heightmap.fill(0);
+    m_sectionBlockCounts.fill(0);
+    m_light.fill(0);
+    m_isDirty = true;
 }
 
 const ChunkCoord &Chunk::coord(void) const
@@ -40,10 +76,152 @@ void Chunk::set(uint32_t x, uint32_t y, uint32_t z, BlockType block)
         throw std::out_of_range("Chunk::set(): local block coordinate is out of range");
     }
 
-    m_blocks.at(index(x, y, z)) = block;
+    BlockType &current = m_blocks.at(index(x, y, z));
+    const BlockType previous = current;
+    current = block;
+    trackBlockChange(x, y, z, previous, block);
     m_isDirty = true;
 }
 
+Chunk::EditSummary Chunk::apply(std::span<const ChunkBlockEdit> edits, std::vector<uint32_t> *changedIndices)
+{
+    EditSummary summary{};
+
+    for (const ChunkBlockEdit &edit : edits)
+    {
+        if (edit.index >= BLOCK_COUNT)
+        {
+            throw std::out_of_range("Chunk::apply(): block index is out of range");
+        }
+
+        BlockType &current = m_blocks[edit.index];
+        if (current == edit.block)
+        {
+            continue;
+        }
+
+        const BlockType previous = current;
+        current = edit.block;
+
+        const uint32_t x = edit.index % WIDTH;
+        const uint32_t z = (edit.index / WIDTH) % DEPTH;
+        const uint32_t y = edit.index / (WIDTH * DEPTH);
+        trackBlockChange(x, y, z, previous, edit.block);
+
+        if (changedIndices != nullptr)
+        {
+            changedIndices->push_back(edit.index);
+        }
+
+        summary.changedBlocks++;
+        summary.minX = std::min(summary.minX, x);
+        summary.maxX = std::max(summary.maxX, x);
+        summary.minZ = std::min(summary.minZ, z);
+        summary.maxZ = std::max(summary.maxZ, z);
+    }
+
+    if (summary.changedBlocks > 0)
+    {
+        m_isDirty = true;
+    }
+
+    return summary;
+}
+
+Chunk::EditSummary Chunk::fill(uint32_t minX, uint32_t minY, uint32_t minZ, uint32_t maxX, uint32_t maxY, uint32_t maxZ, BlockType block, std::vector<uint32_t> *changedIndices)
+{
+    if (maxX >= WIDTH || maxY >= HEIGHT || maxZ >= DEPTH || minX > maxX || minY > maxY || minZ > maxZ)
+    {
+        throw std::out_of_range("Chunk::fill(): local block region is out of range");
+    }
+
+    EditSummary summary{};
+
+    for (uint32_t y = minY; y <= maxY; y++)
+    {
+        for (uint32_t z = minZ; z <= maxZ; z++)
+        {
+            const size_t rowStart = index(minX, y, z);
+
+            for (uint32_t x = minX; x <= maxX; x++)
+            {
+                BlockType &current = m_blocks[rowStart + (x - minX)];
+                if (current == block)
+                {
+                    continue;
+                }
+
+                const BlockType previous = current;
+                current = block;
+                trackBlockChange(x, y, z, previous, block);
+
+                if (changedIndices != nullptr)
+                {
+                    changedIndices->push_back(static_cast<uint32_t>(rowStart + (x - minX)));
+                }
+
+                summary.changedBlocks++;
+                summary.minX = std::min(summary.minX, x);
+                summary.maxX = std::max(summary.maxX, x);
+                summary.minZ = std::min(summary.minZ, z);
+                summary.maxZ = std::max(summary.maxZ, z);
+            }
+        }
+    }
+
+    if (summary.changedBlocks > 0)
+    {
+        m_isDirty = true;
+    }
+
+    return summary;
+}
+
+std::span<const BlockType, Chunk::BLOCK_COUNT> Chunk::blocks(void) const
+{
+    return m_blocks;
+}
+
+uint32_t Chunk::columnHeight(uint32_t x, uint32_t z) const
+{
+    return m_heightmap.at(static_cast<size_t>(x) + static_cast<size_t>(WIDTH) * static_cast<size_t>(z));
+}
+
+bool Chunk::sectionEmpty(uint32_t section) const
+{
+    return m_sectionBlockCounts.at(section) == 0;
+}
+
+uint8_t Chunk::packedLight(size_t index) const
+{
+    return m_light[index];
+}
+
+uint8_t Chunk::skyLight(size_t index) const
+{
+    return static_cast<uint8_t>(m_light[index] >> 4u);
+}
+
+uint8_t Chunk::blockLight(size_t index) const
+{
+    return static_cast<uint8_t>(m_light[index] & 0x0Fu);
+}
+
+void Chunk::setSkyLight(size_t index, uint8_t level)
+{
+    m_light[index] = static_cast<uint8_t>((m_light[index] & 0x0Fu) | (level << 4u));
+}
+
+void Chunk::setBlockLight(size_t index, uint8_t level)
+{
+    m_light[index] = static_cast<uint8_t>((m_light[index] & 0xF0u) | (level & 0x0Fu));
+}
+
+void Chunk::clearLight(void)
+{
+    m_light.fill(0);
+}
+
 bool Chunk::dirty(void) const
 {
     return m_isDirty;
@@ -63,3 +241,43 @@ size_t Chunk::index(uint32_t x, uint32_t y, uint32_t z)
 {
     return static_cast<size_t>(x) + static_cast<size_t>(WIDTH) * (static_cast<size_t>(z) + static_cast<size_t>(DEPTH) * static_cast<size_t>(y));
 }
+
+ChunkCoord Chunk::coordAt(const int32_t worldX, const int32_t worldZ)
+{
+    return ChunkCoord{
+        .x = floorDiv(worldX, static_cast<int32_t>(WIDTH)),
+        .z = floorDiv(worldZ, static_cast<int32_t>(DEPTH)),
+    };
+}
+
+void Chunk::trackBlockChange(uint32_t x, uint32_t y, uint32_t z, BlockType previous, BlockType block)
+{
+    const bool wasSolid = previous != BlockType::Air;
+    const bool isSolid = block != BlockType::Air;
+    if (wasSolid == isSolid)
+    {
+        return;
+    }
+
+    uint16_t &sectionCount = m_sectionBlockCounts[y / SECTION_HEIGHT];
+    sectionCount = static_cast<uint16_t>(isSolid ? sectionCount + 1 : sectionCount - 1);
+
+    uint8_t &height = m_heightmap[static_cast<size_t>(x) + static_cast<size_t>(WIDTH) * static_cast<size_t>(z)];
+    if (isSolid)
+    {
+        height = std::max(height, static_cast<uint8_t>(y + 1));
+        return;
+    }
+
+    /* Removing the top block of a column - walk down to the next solid block */
+    if (y + 1 == height)
+    {
+        uint32_t newHeight = y;
+        while (newHeight > 0 && m_blocks[index(x, newHeight - 1, z)] == BlockType::Air)
+        {
+            --newHeight;
+        }
+
+        height = static_cast<uint8_t>(newHeight);
+    }
+}
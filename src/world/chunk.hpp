@@ -6,6 +6,8 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <span>
+#include <vector>
 
 struct ChunkCoord
 {
@@ -15,6 +17,12 @@ struct ChunkCoord
     [[nodiscard]] bool operator==(const ChunkCoord &other) const = default;
 };
 
+struct ChunkBlockEdit
+{
+    uint32_t index = 0;
+    BlockType block = BlockType::Air;
+};
+
 class Chunk
 {
 public:
@@ -22,9 +30,28 @@ public:
     static constexpr uint32_t DEPTH = 32;
     static constexpr uint32_t HEIGHT = 64;
     static constexpr uint32_t BLOCK_COUNT = WIDTH * DEPTH * HEIGHT;
+    static constexpr uint32_t SECTION_HEIGHT = 16;
+    static constexpr uint32_t SECTION_COUNT = HEIGHT / SECTION_HEIGHT;
+    static constexpr uint8_t MAX_LIGHT = 15;
+
+    static_assert(HEIGHT % SECTION_HEIGHT == 0, "sections must evenly divide the chunk height");
+    static_assert(HEIGHT <= UINT8_MAX, "the heightmap stores column heights as uint8_t");
+
+    /* Which part of the chunk a batch of edits actually changed, so callers know which neighbours to re-mesh */
+    struct EditSummary
+    {
+        uint32_t changedBlocks = 0;
+        uint32_t minX = WIDTH;
+        uint32_t maxX = 0;
+        uint32_t minZ = DEPTH;
+        uint32_t maxZ = 0;
+    };
 
     explicit Chunk(ChunkCoord coord = {});
 
+    /* Turns a recycled chunk into an empty, unlit one at coord. Only the sections that still hold blocks are cleared */
+    void reset(ChunkCoord coord);
+
     [[nodiscard]] const ChunkCoord &coord(void) const;
     [[nodiscard]] int32_t minBlockX(void) const;
     [[nodiscard]] int32_t minBlockZ(void) const;
@@ -32,25 +59,62 @@ public:
     [[nodiscard]] BlockType get(uint32_t x, uint32_t y, uint32_t z) const;
     void set(uint32_t x, uint32_t y, uint32_t z, BlockType block);
 
+    /* Batch edits: indices must come from index(), the chunk is only marked dirty once and only if something changed.
+       If changedIndices is given, the index of every block that actually changed is appended to it */
+    EditSummary apply(std::span<const ChunkBlockEdit> edits, std::vector<uint32_t> *changedIndices = nullptr);
+    EditSummary fill(uint32_t minX, uint32_t minY, uint32_t minZ, uint32_t maxX, uint32_t maxY, uint32_t maxZ, BlockType block, std::vector<uint32_t> *changedIndices = nullptr);
+
+    /* Unchecked, read-only view of the blocks in index() order for hot query loops */
+    [[nodiscard]] std::span<const BlockType, BLOCK_COUNT> blocks(void) const;
+
+    /* One above the highest non-air block in the column, 0 for an empty column */
+    [[nodiscard]] uint32_t columnHeight(uint32_t x, uint32_t z) const;
+    [[nodiscard]] bool sectionEmpty(uint32_t section) const;
+
+    /* Light is stored nibble-packed per block in index() order: sky light in the high nibble, block light in the low one.
+       The accessors are unchecked, they sit in the light engine's and the mesher's inner loops */
+    [[nodiscard]] uint8_t packedLight(size_t index) const;
+    [[nodiscard]] uint8_t skyLight(size_t index) const;
+    [[nodiscard]] uint8_t blockLight(size_t index) const;
+    void setSkyLight(size_t index, uint8_t level);
+    void setBlockLight(size_t index, uint8_t level);
+    void clearLight(void);
+
     [[nodiscard]] bool dirty(void) const;
     void markDirty(void);
     void clearDirty(void);
 
-private:
     [[nodiscard]] static size_t index(const uint32_t x, const uint32_t y, const uint32_t z);
 
+    /* The chunk that contains a world-space block column */
+    [[nodiscard]] static ChunkCoord coordAt(const int32_t worldX, const int32_t worldZ);
+
+private:
+    void trackBlockChange(uint32_t x, uint32_t y, uint32_t z, BlockType previous, BlockType block);
+
     ChunkCoord m_coord{};
     std::array<BlockType, BLOCK_COUNT> m_blocks{};
+    std::array<uint8_t, WIDTH * DEPTH> m_heightmap{};
+    std::array<uint16_t, SECTION_COUNT> m_sectionBlockCounts{};
+    std::array<uint8_t, BLOCK_COUNT> m_light{};
     bool m_isDirty = true;
 };
 
+/* splitmix64's finalizer over both coordinates packed into one word. Chunk coordinates are small and clustered, the plain
+   (x << 32) ^ z left the low bits - the ones a power-of-two table indexes with - to z alone, so whole rows collided */
+[[nodiscard]] constexpr uint64_t hashChunkCoord(const ChunkCoord coord)
+{
+    uint64_t hash = (static_cast<uint64_t>(static_cast<uint32_t>(coord.x)) << 32u) | static_cast<uint32_t>(coord.z);
+    hash = (hash ^ (hash >> 30u)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27u)) * 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31u);
+}
+
 template <>
 struct std::hash<ChunkCoord>
 {
     [[nodiscard]] size_t operator()(const ChunkCoord &coord) const noexcept
     {
-        const uint64_t x = static_cast<uint32_t>(coord.x);
-        const uint64_t z = static_cast<uint32_t>(coord.z);
-        return static_cast<size_t>((x << 32u) ^ z);
+        return static_cast<size_t>(hashChunkCoord(coord));
     }
 };
@@ -12,7 +12,12 @@ ChunkGenerator::ChunkGenerator(const int32_t seed) : m_seed(seed){}
 Chunk ChunkGenerator::generate(const ChunkCoord coord) const
 {
     Chunk chunk(coord);
+    generate(chunk);
+    return chunk;
+}
 
+void ChunkGenerator::generate(Chunk &chunk) const
+{
     FastNoiseLite elevationNoise(m_seed);
     elevationNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
     elevationNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
@@ -71,5 +76,4 @@ Chunk ChunkGenerator::generate(const ChunkCoord coord) const
     }
 
     chunk.clearDirty();
-    return chunk;
 }
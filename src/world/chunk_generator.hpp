@@ -13,6 +13,9 @@ public:
 
     [[nodiscard]] Chunk generate(const ChunkCoord coord) const;
 
+    /* Generates into storage the caller already has, which must be an empty chunk - fresh, or straight out of a ChunkPool */
+    void generate(Chunk &chunk) const;
+
 private:
     const uint32_t SEA_LEVEL = 22;
 
@@ -0,0 +1,220 @@
+#include "world/chunk_map.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+Chunk *ChunkMap::find(const ChunkCoord coord)
+{
+    if (m_slots.empty())
+    {
+        return nullptr;
+    }
+
+    return m_slots[probe(coord)].chunk.get();
+}
+
+const Chunk *ChunkMap::find(const ChunkCoord coord) const
+{
+    if (m_slots.empty())
+    {
+        return nullptr;
+    }
+
+    return m_slots[probe(coord)].chunk.get();
+}
+
+bool ChunkMap::contains(const ChunkCoord coord) const
+{
+    return find(coord) != nullptr;
+}
+
+Chunk &ChunkMap::at(const ChunkCoord coord)
+{
+    Chunk *chunk = find(coord);
+    if (chunk == nullptr)
+    {
+        throw std::out_of_range("Chunk is not loaded");
+    }
+
+    return *chunk;
+}
+
+const Chunk &ChunkMap::at(const ChunkCoord coord) const
+{
+    const Chunk *chunk = find(coord);
+    if (chunk == nullptr)
+    {
+        throw std::out_of_range("Chunk is not loaded");
+    }
+
+    return *chunk;
+}
+
+Chunk &ChunkMap::emplace(const ChunkCoord coord)
+{
+    reserve(m_size + 1);
+
+    Slot &slot = m_slots[probe(coord)];
+    if (slot.chunk != nullptr)
+    {
+        slot.chunk->reset(coord);
+        return *slot.chunk;
+    }
+
+    slot.coord = coord;
+    slot.chunk = m_pool.acquire(coord);
+    m_size++;
+    return *slot.chunk;
+}
+
+Chunk &ChunkMap::insert(Chunk chunk)
+{
+    reserve(m_size + 1);
+
+    const ChunkCoord coord = chunk.coord();
+    Slot &slot = m_slots[probe(coord)];
+    if (slot.chunk != nullptr)
+    {
+        *slot.chunk = std::move(chunk);
+        return *slot.chunk;
+    }
+
+    slot.coord = coord;
+    slot.chunk = std::make_unique<Chunk>(std::move(chunk));
+    m_size++;
+    return *slot.chunk;
+}
+
+bool ChunkMap::erase(const ChunkCoord coord)
+{
+    if (m_slots.empty())
+    {
+        return false;
+    }
+
+    size_t hole = probe(coord);
+    if (m_slots[hole].chunk == nullptr)
+    {
+        return false;
+    }
+
+    m_pool.release(std::move(m_slots[hole].chunk));
+    m_size--;
+
+    /* Backward shift: pull every later entry of the run into the hole unless that would move it in front of its home slot */
+    const size_t mask = m_slots.size() - 1;
+    for (size_t next = (hole + 1) & mask; m_slots[next].chunk != nullptr; next = (next + 1) & mask)
+    {
+        const size_t home = homeSlot(m_slots[next].coord);
+        const size_t distanceToHole = (hole - home) & mask;
+        const size_t distanceToNext = (next - home) & mask;
+        if (distanceToHole < distanceToNext)
+        {
+            m_slots[hole] = std::move(m_slots[next]);
+            hole = next;
+        }
+    }
+
+    return true;
+}
+
+void ChunkMap::clear(void)
+{
+    for (Slot &slot : m_slots)
+    {
+        m_pool.release(std::move(slot.chunk));
+    }
+
+    m_size = 0;
+}
+
+void ChunkMap::reserve(const size_t count)
+{
+    if (count * MAX_LOAD_DENOMINATOR <= m_slots.size() * MAX_LOAD_NUMERATOR)
+    {
+        return;
+    }
+
+    rehash(std::bit_ceil(std::max(MIN_CAPACITY, count * MAX_LOAD_DENOMINATOR / MAX_LOAD_NUMERATOR)));
+}
+
+size_t ChunkMap::size(void) const
+{
+    return m_size;
+}
+
+bool ChunkMap::empty(void) const
+{
+    return m_size == 0;
+}
+
+size_t ChunkMap::memoryBytes(void) const
+{
+    return (m_size + m_pool.spareCount()) * sizeof(Chunk) + m_slots.size() * sizeof(Slot);
+}
+
+size_t ChunkMap::loadedBytes(void) const
+{
+    return m_size * sizeof(Chunk) + m_slots.size() * sizeof(Slot);
+}
+
+void ChunkMap::adoptSpares(ChunkMap &other)
+{
+    m_pool.adopt(other.m_pool);
+}
+
+void ChunkMap::setMaxSpares(const size_t count)
+{
+    m_pool.setMaxSpares(count);
+}
+
+ChunkMap::Iterator ChunkMap::begin(void)
+{
+    return Iterator(m_slots.begin(), m_slots.end());
+}
+
+ChunkMap::Iterator ChunkMap::end(void)
+{
+    return Iterator(m_slots.end(), m_slots.end());
+}
+
+ChunkMap::ConstIterator ChunkMap::begin(void) const
+{
+    return ConstIterator(m_slots.begin(), m_slots.end());
+}
+
+ChunkMap::ConstIterator ChunkMap::end(void) const
+{
+    return ConstIterator(m_slots.end(), m_slots.end());
+}
+
+size_t ChunkMap::probe(const ChunkCoord coord) const
+{
+    const size_t mask = m_slots.size() - 1;
+    size_t index = homeSlot(coord);
+    while (m_slots[index].chunk != nullptr && !(m_slots[index].coord == coord))
+    {
+        index = (index + 1) & mask;
+    }
+
+    return index;
+}
+
+size_t ChunkMap::homeSlot(const ChunkCoord coord) const
+{
+    return static_cast<size_t>(hashChunkCoord(coord)) & (m_slots.size() - 1);
+}
+
+void ChunkMap::rehash(const size_t capacity)
+{
+    std::vector<Slot> previous = std::exchange(m_slots, std::vector<Slot>(capacity));
+    for (Slot &slot : previous)
+    {
+        if (slot.chunk != nullptr)
+        {
+            m_slots[probe(slot.coord)] = std::move(slot);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "world/chunk.hpp"
+#include "world/chunk_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+/* Open-addressing hash map from chunk coordinates to chunks. The slots are one flat, power-of-two sized array of
+   (coordinate, chunk pointer) pairs probed linearly, so a lookup hashes once and then reads neighbouring slots instead of
+   walking a bucket list. Chunks come out of the map's own ChunkPool and never move, pointers to them stay valid while the
+   table grows and until they are erased. Erasing shifts the rest of the probe run back, so there are no tombstones to slow
+   later lookups down, and hands the chunk back to the pool for the next emplace() */
+class ChunkMap
+{
+    struct Slot
+    {
+        ChunkCoord coord{};
+        std::unique_ptr<Chunk> chunk{};
+    };
+
+    template <typename ChunkType, typename SlotIterator>
+    class BasicIterator
+    {
+    public:
+        struct Entry
+        {
+            ChunkCoord coord{};
+            ChunkType &chunk;
+        };
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+
+        BasicIterator(void) = default;
+        BasicIterator(const SlotIterator slot, const SlotIterator end) : m_slot(slot), m_end(end)
+        {
+            skipEmpty();
+        }
+
+        [[nodiscard]] Entry operator*(void) const
+        {
+            return Entry{ .coord = m_slot->coord, .chunk = *m_slot->chunk };
+        }
+
+        BasicIterator &operator++(void)
+        {
+            ++m_slot;
+            skipEmpty();
+            return *this;
+        }
+
+        BasicIterator operator++(int)
+        {
+            BasicIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        [[nodiscard]] bool operator==(const BasicIterator &other) const
+        {
+            return m_slot == other.m_slot;
+        }
+
+    private:
+        void skipEmpty(void)
+        {
+            while (m_slot != m_end && m_slot->chunk == nullptr)
+            {
+                ++m_slot;
+            }
+        }
+
+        SlotIterator m_slot{};
+        SlotIterator m_end{};
+    };
+
+public:
+    using Iterator = BasicIterator<Chunk, std::vector<Slot>::iterator>;
+    using ConstIterator = BasicIterator<const Chunk, std::vector<Slot>::const_iterator>;
+
+    [[nodiscard]] Chunk *find(const ChunkCoord coord);
+    [[nodiscard]] const Chunk *find(const ChunkCoord coord) const;
+    [[nodiscard]] bool contains(const ChunkCoord coord) const;
+
+    /* Throws std::out_of_range if the chunk isn't in the map */
+    [[nodiscard]] Chunk &at(const ChunkCoord coord);
+    [[nodiscard]] const Chunk &at(const ChunkCoord coord) const;
+
+    /* An empty chunk at coord, from recycled storage when the pool has some. A chunk already stored there is emptied */
+    Chunk &emplace(const ChunkCoord coord);
+
+    /* Keyed by the chunk's own coordinate, a chunk already stored there is replaced */
+    Chunk &insert(Chunk chunk);
+    bool erase(const ChunkCoord coord);
+    void clear(void);
+
+    /* Sizes the table so that count chunks fit without growing it again */
+    void reserve(const size_t count);
+
+    [[nodiscard]] size_t size(void) const;
+    [[nodiscard]] bool empty(void) const;
+
+    /* The chunks, the pool's spares and the slot table */
+    [[nodiscard]] size_t memoryBytes(void) const;
+
+    /* Same without the pool's spares, whose number has its own cap */
+    [[nodiscard]] size_t loadedBytes(void) const;
+
+    /* Takes over the spares of another map's pool, e.g. of the map this one replaces */
+    void adoptSpares(ChunkMap &other);
+    void setMaxSpares(const size_t count);
+
+    [[nodiscard]] Iterator begin(void);
+    [[nodiscard]] Iterator end(void);
+    [[nodiscard]] ConstIterator begin(void) const;
+    [[nodiscard]] ConstIterator end(void) const;
+
+private:
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    /* Linear probing degrades quickly past half full, and a slot is only 16 bytes */
+    static constexpr size_t MAX_LOAD_NUMERATOR = 1;
+    static constexpr size_t MAX_LOAD_DENOMINATOR = 2;
+
+    /* Index of the slot holding coord, or of the empty slot that ends its probe run. The table must not be empty */
+    [[nodiscard]] size_t probe(const ChunkCoord coord) const;
+    [[nodiscard]] size_t homeSlot(const ChunkCoord coord) const;
+    void rehash(const size_t capacity);
+
+    std::vector<Slot> m_slots{};
+    size_t m_size = 0;
+    ChunkPool m_pool{};
+};
@@ -0,0 +1,52 @@
+#include "world/chunk_map_block_provider.hpp"
+
+ChunkMapBlockProvider::ChunkMapBlockProvider(const ChunkMap &chunks) : m_chunks(chunks){}
+
+BlockType ChunkMapBlockProvider::blockAt(const int32_t worldX, const int32_t y, const int32_t worldZ) const
+{
+    if (y < 0 || y >= static_cast<int32_t>(Chunk::HEIGHT))
+    {
+        return BlockType::Air;
+    }
+
+    const Chunk *chunk = chunkAt(worldX, worldZ);
+    if (chunk == nullptr)
+    {
+        return BlockType::Air;
+    }
+
+    const uint32_t localX = static_cast<uint32_t>(worldX - chunk->minBlockX());
+    const uint32_t localZ = static_cast<uint32_t>(worldZ - chunk->minBlockZ());
+    return chunk->blocks()[Chunk::index(localX, static_cast<uint32_t>(y), localZ)];
+}
+
+uint8_t ChunkMapBlockProvider::lightAt(const int32_t worldX, const int32_t y, const int32_t worldZ) const
+{
+    if (y < 0)
+    {
+        return 0;
+    }
+
+    const Chunk *chunk = y < static_cast<int32_t>(Chunk::HEIGHT) ? chunkAt(worldX, worldZ) : nullptr;
+    if (chunk == nullptr)
+    {
+        return static_cast<uint8_t>(Chunk::MAX_LIGHT << 4u);
+    }
+
+    const uint32_t localX = static_cast<uint32_t>(worldX - chunk->minBlockX());
+    const uint32_t localZ = static_cast<uint32_t>(worldZ - chunk->minBlockZ());
+    return chunk->packedLight(Chunk::index(localX, static_cast<uint32_t>(y), localZ));
+}
+
+const Chunk *ChunkMapBlockProvider::chunkAt(const int32_t worldX, const int32_t worldZ) const
+{
+    const ChunkCoord coord = Chunk::coordAt(worldX, worldZ);
+    if (!m_hasCachedCoord || !(coord == m_cachedCoord))
+    {
+        m_cachedChunk = m_chunks.find(coord);
+        m_cachedCoord = coord;
+        m_hasCachedCoord = true;
+    }
+
+    return m_cachedChunk;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "world/chunk_map.hpp"
+#include "world/chunk_mesher.hpp"
+
+#include <cstdint>
+
+/* Serves the mesher's border lookups from a ChunkMap: unloaded chunks are air and open sky. It caches the chunk of the previous
+   lookup, so it is cheap to make one per mesh job and unsafe to share one between threads */
+class ChunkMapBlockProvider final : public ChunkBlockProvider
+{
+public:
+    explicit ChunkMapBlockProvider(const ChunkMap &chunks);
+
+    [[nodiscard]] BlockType blockAt(const int32_t worldX, const int32_t y, const int32_t worldZ) const override;
+    [[nodiscard]] uint8_t lightAt(const int32_t worldX, const int32_t y, const int32_t worldZ) const override;
+
+private:
+    /* The mesher asks for whole runs of blocks along one neighbouring border, so most lookups hit the previous chunk */
+    [[nodiscard]] const Chunk *chunkAt(const int32_t worldX, const int32_t worldZ) const;
+
+    const ChunkMap &m_chunks;
+    mutable const Chunk *m_cachedChunk = nullptr;
+    mutable ChunkCoord m_cachedCoord{};
+    mutable bool m_hasCachedCoord = false;
+};
@@ -2,16 +2,13 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
+#include <span>
 #include <vector>
 
 namespace
 {
-    constexpr float ATLAS_WIDTH = 64.0f;
-    constexpr float ATLAS_HEIGHT = 48.0f;
-    constexpr float ATLAS_TILE_SIZE = 16.0f;
-    constexpr float ATLAS_TEXEL_PADDING = 0.5f;
-
     [[nodiscard]] uint32_t sanitizeLodStep(uint32_t lodStep)
     {
         if (lodStep >= 4 && Chunk::WIDTH % 4 == 0 && Chunk::DEPTH % 4 == 0 && Chunk::HEIGHT % 4 == 0)
@@ -27,54 +24,6 @@ namespace
         return 1;
     }
 
-    [[nodiscard]] glm::vec4 texAtlas(uint32_t tileX, uint32_t tileY)
-    {
-        return glm::vec4 {
-            (static_cast<float>(tileX) * ATLAS_TILE_SIZE + ATLAS_TEXEL_PADDING) / ATLAS_WIDTH,
-            (static_cast<float>(tileY) * ATLAS_TILE_SIZE + ATLAS_TEXEL_PADDING) / ATLAS_HEIGHT,
-            (ATLAS_TILE_SIZE - ATLAS_TEXEL_PADDING * 2.0f) / ATLAS_WIDTH,
-            (ATLAS_TILE_SIZE - ATLAS_TEXEL_PADDING * 2.0f) / ATLAS_HEIGHT,
-        };
-    }
-
-    [[nodiscard]] glm::vec4 texAtlasForFace(const BlockType blockType, const uint32_t axis, bool isPositive)
-    {
-        switch (blockType)
-        {
-            case BlockType::Grass:
-                if (axis == 1 && isPositive)
-                {
-                    return texAtlas(2, 0);
-                }
-
-                if (axis == 1 && !isPositive)
-                {
-                    return texAtlas(0, 0);
-                }
-                else
-                {
-                    return texAtlas(1, 0);
-                }
-            
-            case BlockType::Sand:
-                return texAtlas(3, 0);
-            
-            case BlockType::Dirt:
-                return texAtlas(0, 0);
-            
-            case BlockType::Stone:
-                return texAtlas(0, 1);
-            
-            case BlockType::Air:
-                break;
-
-            default:
-                break;
-        }
-
-        return texAtlas(0, 0);
-    }
-
     [[nodiscard]] glm::vec3 faceShade(const uint32_t axis, const bool isPositive)
     {
         float shade = 0.75;
@@ -96,8 +45,95 @@ namespace
         return glm::vec3{ shade };
     }
 
-    [[nodiscard]] BlockType dominantBlockInRegion(const ChunkBlockProvider &blocks, int32_t x, int32_t y, int32_t z, uint32_t size)
+    /* Each light level is 80% as bright as the one above it, the floor keeps unlit caves from going pitch black */
+    [[nodiscard]] float lightBrightness(const uint8_t packedLight)
+    {
+        const uint32_t level = std::max(static_cast<uint32_t>(packedLight >> 4u), static_cast<uint32_t>(packedLight & 0x0Fu));
+        return std::max(std::pow(0.8f, static_cast<float>(Chunk::MAX_LIGHT - level)), 0.05f);
+    }
+
+    /* Brightest sky and block light over a LOD cell given in chunk-local blocks, cells outside of the chunk come from the provider */
+    [[nodiscard]] uint8_t lightInRegion(const Chunk &chunk, const ChunkBlockProvider &blocks, int32_t x, int32_t y, int32_t z, uint32_t size)
+    {
+        uint32_t sky = 0;
+        uint32_t block = 0;
+
+        for (uint32_t dy = 0; dy < size; dy++)
+        {
+            for (uint32_t dz = 0; dz < size; dz++)
+            {
+                for (uint32_t dx = 0; dx < size; dx++)
+                {
+                    const int32_t sampleX = x + static_cast<int32_t>(dx);
+                    const int32_t sampleY = y + static_cast<int32_t>(dy);
+                    const int32_t sampleZ = z + static_cast<int32_t>(dz);
+
+                    uint8_t light = 0;
+                    if (sampleX >= 0 && sampleY >= 0 && sampleZ >= 0 &&
+                        sampleX < static_cast<int32_t>(Chunk::WIDTH) &&
+                        sampleY < static_cast<int32_t>(Chunk::HEIGHT) &&
+                        sampleZ < static_cast<int32_t>(Chunk::DEPTH))
+                    {
+                        light = chunk.packedLight(Chunk::index(static_cast<uint32_t>(sampleX), static_cast<uint32_t>(sampleY), static_cast<uint32_t>(sampleZ)));
+                    }
+                    else
+                    {
+                        light = blocks.lightAt(chunk.minBlockX() + sampleX, sampleY, chunk.minBlockZ() + sampleZ);
+                    }
+
+                    sky = std::max(sky, static_cast<uint32_t>(light >> 4u));
+                    block = std::max(block, static_cast<uint32_t>(light & 0x0Fu));
+                }
+            }
+        }
+
+        return static_cast<uint8_t>((sky << 4u) | block);
+    }
+
+    /* Classic voxel AO: how many of the three blocks around a vertex on the open side of a face are solid, 3 is fully open */
+    [[nodiscard]] uint8_t vertexAmbientOcclusion(const bool side1, const bool side2, const bool corner)
     {
+        if (side1 && side2)
+        {
+            return 0;
+        }
+
+        return static_cast<uint8_t>(3 - static_cast<uint8_t>(side1) - static_cast<uint8_t>(side2) - static_cast<uint8_t>(corner));
+    }
+
+    constexpr std::array<float, 4> AMBIENT_OCCLUSION_BRIGHTNESS = { 0.45f, 0.65f, 0.82f, 1.0f };
+
+    /* A visible face in the greedy mask. Faces only merge when the block, the light in front of it and the AO of all
+       four corners (2 bits each, corners ordered -u-v, +u-v, +u+v, -u+v) match */
+    struct FaceMask
+    {
+        BlockType block = BlockType::Air;
+        uint8_t light = 0;
+        uint8_t ambientOcclusion = 0;
+
+        [[nodiscard]] bool operator==(const FaceMask &other) const = default;
+    };
+
+    [[nodiscard]] uint8_t cornerAmbientOcclusion(const uint8_t signature, const uint32_t corner)
+    {
+        return static_cast<uint8_t>((signature >> (corner * 2u)) & 0x3u);
+    }
+
+    /* Which AO corner each of a quad's four vertices sits on - both orders wind counter-clockwise seen from the open side */
+    constexpr std::array<uint32_t, 4> POSITIVE_FACE_CORNERS = { 0, 1, 2, 3 };
+    constexpr std::array<uint32_t, 4> NEGATIVE_FACE_CORNERS = { 0, 3, 2, 1 };
+
+    /* Offsets along the face's u and v axes of each AO corner */
+    constexpr std::array<std::array<uint32_t, 2>, 4> CORNER_OFFSETS = {{ { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } }};
+
+    template <typename Sample>
+    [[nodiscard]] BlockType dominantBlock(const uint32_t size, Sample &&sample)
+    {
+        if (size == 1)
+        {
+            return sample(0, 0, 0);
+        }
+
         std::array<uint32_t, BLOCK_TYPE_COUNT> counts{};
 
         for (uint32_t dy = 0; dy < size; dy++)
@@ -106,8 +142,7 @@ namespace
             {
                 for (uint32_t dx = 0; dx < size; dx++)
                 {
-                    const BlockType block = blocks.blockAt(x + static_cast<int32_t>(dx), y + static_cast<int32_t>(dy), z + static_cast<int32_t>(dz));
-                    ++counts.at(static_cast<size_t>(block));
+                    ++counts.at(static_cast<size_t>(sample(dx, dy, dz)));
                 }
             }
         }
@@ -126,106 +161,121 @@ namespace
         return bestCount == 0 ? BlockType::Air : static_cast<BlockType>(bestIndex);
     }
 
-    void appendGreedyQuad
-    (
-        ChunkMesh &mesh,
-        BlockType block,
-        uint32_t axis,
-        bool isPositive,
-        uint32_t plane,
-        uint32_t u0,
-        uint32_t v0,
-        uint32_t u1,
-        uint32_t v1,
-        uint32_t step,
-        const Chunk &chunk,
-        const glm::vec3 &positionOffset
-    )
+    /* The chunk's LOD cells plus a one cell border sampled from its neighbours, so face visibility and AO are plain array reads */
+    class PaddedBlocks
     {
-        const uint32_t uAxis = (axis + 1) % 3;
-        const uint32_t vAxis = (axis + 2) % 3;
-        
-        auto makePosition = [&](const uint32_t axisCoordinate, const uint32_t uCoordinate, const uint32_t vCoordinate)
+    public:
+        PaddedBlocks(const Chunk &chunk, const ChunkBlockProvider &blocks, const uint32_t step)
+            : m_width(Chunk::WIDTH / step + 2), m_height(Chunk::HEIGHT / step + 2), m_depth(Chunk::DEPTH / step + 2)
         {
-            std::array<float, 3> coordinates{};
-            coordinates.at(axis) = static_cast<float>(axisCoordinate * step);
-            coordinates.at(uAxis) = static_cast<float>(uCoordinate * step);
-            coordinates.at(vAxis) = static_cast<float>(vCoordinate * step);
-
-            return glm::vec3{
-                static_cast<float>(chunk.minBlockX()) + coordinates.at(0),
-                coordinates.at(1),
-                static_cast<float>(chunk.minBlockZ()) + coordinates.at(2),
-            } + positionOffset;
-        };
+            m_cells.resize(static_cast<size_t>(m_width) * static_cast<size_t>(m_height) * static_cast<size_t>(m_depth), BlockType::Air);
 
-        auto makeTexCoord = [&](const glm::vec3 &position)
-        {
-            if (axis == 0)
-            {
-                return glm::vec2{ position.z, -position.y };
-            }
+            const std::span<const BlockType, Chunk::BLOCK_COUNT> chunkBlocks = chunk.blocks();
+            const int32_t lodStep = static_cast<int32_t>(step);
 
-            if (axis == 2)
+            for (uint32_t paddedY = 0; paddedY < m_height; paddedY++)
             {
-                return glm::vec2{ position.x, -position.y };
-            }
-
-            return glm::vec2{ position.x, position.z };
-        };
+                for (uint32_t paddedZ = 0; paddedZ < m_depth; paddedZ++)
+                {
+                    for (uint32_t paddedX = 0; paddedX < m_width; paddedX++)
+                    {
+                        const int32_t x = (static_cast<int32_t>(paddedX) - 1) * lodStep;
+                        const int32_t y = (static_cast<int32_t>(paddedY) - 1) * lodStep;
+                        const int32_t z = (static_cast<int32_t>(paddedZ) - 1) * lodStep;
 
-        std::array<glm::vec3, 4> positions{};
-        std::array<glm::vec2, 4> texCoords{};
+                        const bool inside = paddedX > 0 && paddedY > 0 && paddedZ > 0 && paddedX + 1 < m_width && paddedY + 1 < m_height && paddedZ + 1 < m_depth;
+                        BlockType &cell = m_cells[index(paddedX, paddedY, paddedZ)];
 
-        if (isPositive)
-        {
-            positions = {
-                makePosition(plane, u0, v0),
-                makePosition(plane, u1, v0),
-                makePosition(plane, u1, v1),
-                makePosition(plane, u0, v1)
-            };
+                        if (inside)
+                        {
+                            cell = dominantBlock(step, [&](const uint32_t dx, const uint32_t dy, const uint32_t dz) {
+                                return chunkBlocks[Chunk::index(static_cast<uint32_t>(x) + dx, static_cast<uint32_t>(y) + dy, static_cast<uint32_t>(z) + dz)];
+                            });
+                        }
+                        else
+                        {
+                            cell = dominantBlock(step, [&](const uint32_t dx, const uint32_t dy, const uint32_t dz) {
+                                return blocks.blockAt(
+                                    chunk.minBlockX() + x + static_cast<int32_t>(dx),
+                                    y + static_cast<int32_t>(dy),
+                                    chunk.minBlockZ() + z + static_cast<int32_t>(dz));
+                            });
+                        }
+                    }
+                }
+            }
         }
-        else
+
+        /* LOD cell coordinates, -1 and the LOD size address the border */
+        [[nodiscard]] BlockType at(const std::array<int32_t, 3> &coordinates) const
         {
-            positions = {
-                makePosition(plane, u0, v0),
-                makePosition(plane, u0, v1),
-                makePosition(plane, u1, v1),
-                makePosition(plane, u1, v0)
-            };
+            return m_cells[index(
+                static_cast<uint32_t>(coordinates[0] + 1),
+                static_cast<uint32_t>(coordinates[1] + 1),
+                static_cast<uint32_t>(coordinates[2] + 1))];
         }
 
-        for (size_t i = 0; i < positions.size(); ++i)
+        [[nodiscard]] bool solid(const std::array<int32_t, 3> &coordinates) const
         {
-            texCoords.at(i) = makeTexCoord(positions.at(i));
+            return at(coordinates) != BlockType::Air;
         }
 
-        const glm::vec3 color = faceShade(axis, isPositive);
-        const glm::vec4 atlas = texAtlasForFace(block, axis, isPositive);
-        const uint32_t baseIndex = static_cast<uint32_t>(mesh.vertices.size());
-        for (size_t i = 0; i < positions.size(); ++i)
+    private:
+        [[nodiscard]] size_t index(const uint32_t x, const uint32_t y, const uint32_t z) const
         {
-            mesh.vertices.push_back(Voxel{
-                .position = positions.at(i),
-                .color = color,
-                .texCoord = texCoords.at(i),
-                .texAtlas = atlas,
-            });
+            return static_cast<size_t>(x) + static_cast<size_t>(m_width) * (static_cast<size_t>(z) + static_cast<size_t>(m_depth) * static_cast<size_t>(y));
         }
 
-        mesh.indices.push_back(baseIndex + 0);
-        mesh.indices.push_back(baseIndex + 1);
-        mesh.indices.push_back(baseIndex + 2);
-        mesh.indices.push_back(baseIndex + 2);
-        mesh.indices.push_back(baseIndex + 3);
-        mesh.indices.push_back(baseIndex + 0);
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_depth = 0;
+        std::vector<BlockType> m_cells{};
+    };
+
+    void appendGreedyQuad
+    (
+        ChunkMesh &mesh,
+        const FaceMask &face,
+        uint32_t axis,
+        bool isPositive,
+        uint32_t plane,
+        uint32_t u0,
+        uint32_t v0,
+        uint32_t u1,
+        uint32_t v1,
+        uint32_t step
+    )
+    {
+        const uint32_t uAxis = (axis + 1) % 3;
+        const uint32_t vAxis = (axis + 2) % 3;
+
+        glm::uvec3 origin{ 0 };
+        origin[static_cast<int>(axis)] = plane * step;
+        origin[static_cast<int>(uAxis)] = u0 * step;
+        origin[static_cast<int>(vAxis)] = v0 * step;
+
+        /* The quad is split along the 0-2 diagonal of its vertex order. If that diagonal runs into the darker corners, the
+           interpolated AO smears along it - flipped quads start one vertex later so they are split along 1-3 instead */
+        const std::array<uint32_t, 4> &corners = isPositive ? POSITIVE_FACE_CORNERS : NEGATIVE_FACE_CORNERS;
+        const uint32_t diagonal02 = cornerAmbientOcclusion(face.ambientOcclusion, corners[0]) + cornerAmbientOcclusion(face.ambientOcclusion, corners[2]);
+        const uint32_t diagonal13 = cornerAmbientOcclusion(face.ambientOcclusion, corners[1]) + cornerAmbientOcclusion(face.ambientOcclusion, corners[3]);
+
+        mesh.quads.push_back(ChunkQuad::pack(
+            origin,
+            (u1 - u0) * step,
+            (v1 - v0) * step,
+            axis,
+            isPositive,
+            face.block,
+            face.light,
+            face.ambientOcclusion,
+            diagonal02 < diagonal13));
     }
 
     void appendGreedyFacesForAxis
     (
         ChunkMesh &mesh,
-        const std::vector<BlockType> &lodBlocks,
+        const PaddedBlocks &paddedBlocks,
         const ChunkBlockProvider &blocks,
         const Chunk &chunk,
         uint32_t axis,
@@ -243,32 +293,23 @@ namespace
         const uint32_t uLength = dims.at(uAxis);
         const uint32_t vLength = dims.at(vAxis);
 
-        auto localIndex = [&](const uint32_t x, const uint32_t y, const uint32_t z)
+        /* The open cell in front of a face, shifted by (du, dv) within its layer */
+        auto occludes = [&](std::array<int32_t, 3> coordinates, const int32_t du, const int32_t dv)
         {
-            return static_cast<size_t>(x) + static_cast<size_t>(lodWidth) * (static_cast<size_t>(z) + static_cast<size_t>(lodDepth) * static_cast<size_t>(y));
+            coordinates.at(uAxis) += du;
+            coordinates.at(vAxis) += dv;
+            return paddedBlocks.solid(coordinates);
         };
 
-        auto cellAt = [&](const int32_t x, const int32_t y, const int32_t z)
-        {
-            if (x >= 0 && y >= 0 && z >= 0 &&
-                x < static_cast<int32_t>(lodWidth) &&
-                y < static_cast<int32_t>(lodHeight) &&
-                z < static_cast<int32_t>(lodDepth))
-            {
-                return lodBlocks.at(localIndex(static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint32_t>(z)));
-            }
-
-            const int32_t worldX = chunk.minBlockX() + x * static_cast<int32_t>(options.lodStep);
-            const int32_t worldY = y * static_cast<int32_t>(options.lodStep);
-            const int32_t worldZ = chunk.minBlockZ() + z * static_cast<int32_t>(options.lodStep);
-            return dominantBlockInRegion(blocks, worldX, worldY, worldZ, options.lodStep);
-        };
+        std::vector<FaceMask> mask(static_cast<size_t>(uLength) * static_cast<size_t>(vLength));
 
-        std::vector<BlockType> mask(static_cast<size_t>(uLength) * static_cast<size_t>(vLength), BlockType::Air);
+        /* Only faces of the chunk's own cells, the neighbours emit the faces of their border cells themselves */
+        const uint32_t firstPlane = positive ? 1 : 0;
+        const uint32_t lastPlane = positive ? axisLength : axisLength - 1;
 
-        for (uint32_t plane = 0; plane <= axisLength; plane++)
+        for (uint32_t plane = firstPlane; plane <= lastPlane; plane++)
         {
-            std::fill(mask.begin(), mask.end(), BlockType::Air);
+            std::fill(mask.begin(), mask.end(), FaceMask{});
 
             for (uint32_t v = 0; v < vLength; ++v)
             {
@@ -282,17 +323,42 @@ namespace
                     std::array<int32_t, 3> neighborCoordinates = solidCoordinates;
                     neighborCoordinates.at(axis) += positive ? 1 : -1;
 
-                    const BlockType block = cellAt(solidCoordinates.at(0), solidCoordinates.at(1), solidCoordinates.at(2));
+                    const BlockType block = paddedBlocks.at(solidCoordinates);
 
                     if (block == BlockType::Air)
                     {
                         continue;
                     }
 
-                    if (cellAt(neighborCoordinates.at(0), neighborCoordinates.at(1), neighborCoordinates.at(2)) == BlockType::Air)
+                    if (paddedBlocks.solid(neighborCoordinates))
                     {
-                        mask.at(static_cast<size_t>(u) + static_cast<size_t>(uLength) * static_cast<size_t>(v)) = block;
+                        continue;
                     }
+
+                    const uint8_t light = lightInRegion(
+                        chunk,
+                        blocks,
+                        neighborCoordinates.at(0) * static_cast<int32_t>(options.lodStep),
+                        neighborCoordinates.at(1) * static_cast<int32_t>(options.lodStep),
+                        neighborCoordinates.at(2) * static_cast<int32_t>(options.lodStep),
+                        options.lodStep);
+
+                    const bool minusU = occludes(neighborCoordinates, -1, 0);
+                    const bool plusU = occludes(neighborCoordinates, 1, 0);
+                    const bool minusV = occludes(neighborCoordinates, 0, -1);
+                    const bool plusV = occludes(neighborCoordinates, 0, 1);
+
+                    const uint8_t ambientOcclusion = static_cast<uint8_t>(
+                        vertexAmbientOcclusion(minusU, minusV, occludes(neighborCoordinates, -1, -1)) |
+                        vertexAmbientOcclusion(plusU, minusV, occludes(neighborCoordinates, 1, -1)) << 2u |
+                        vertexAmbientOcclusion(plusU, plusV, occludes(neighborCoordinates, 1, 1)) << 4u |
+                        vertexAmbientOcclusion(minusU, plusV, occludes(neighborCoordinates, -1, 1)) << 6u);
+
+                    mask.at(static_cast<size_t>(u) + static_cast<size_t>(uLength) * static_cast<size_t>(v)) = FaceMask{
+                        .block = block,
+                        .light = light,
+                        .ambientOcclusion = ambientOcclusion,
+                    };
                 }
             }
 
@@ -300,15 +366,15 @@ namespace
             {
                 for (uint32_t u = 0; u < uLength;)
                 {
-                    const BlockType block = mask.at(static_cast<size_t>(u) + static_cast<size_t>(uLength) * static_cast<size_t>(v));
-                    if (block == BlockType::Air)
+                    const FaceMask face = mask.at(static_cast<size_t>(u) + static_cast<size_t>(uLength) * static_cast<size_t>(v));
+                    if (face.block == BlockType::Air)
                     {
                         ++u;
                         continue;
                     }
 
                     uint32_t width = 1;
-                    while (u + width < uLength && mask.at(static_cast<size_t>(u + width) + static_cast<size_t>(uLength) * static_cast<size_t>(v)) == block)
+                    while (u + width < uLength && mask.at(static_cast<size_t>(u + width) + static_cast<size_t>(uLength) * static_cast<size_t>(v)) == face)
                     {
                         width++;
                     }
@@ -319,7 +385,7 @@ namespace
                     {
                         for (uint32_t scanU = 0; scanU < width; scanU++)
                         {
-                            if (mask.at(static_cast<size_t>(u + scanU) + static_cast<size_t>(uLength) * static_cast<size_t>(v + height)) != block)
+                            if (mask.at(static_cast<size_t>(u + scanU) + static_cast<size_t>(uLength) * static_cast<size_t>(v + height)) != face)
                             {
                                 canGrow = false;
                                 break;
@@ -332,13 +398,13 @@ namespace
                         }
                     }
 
-                    appendGreedyQuad(mesh, block, axis, positive, plane, u, v, u + width, v + height, options.lodStep, chunk, options.positionOffset);
+                    appendGreedyQuad(mesh, face, axis, positive, plane, u, v, u + width, v + height, options.lodStep);
 
                     for (uint32_t clearV = 0; clearV < height; clearV++)
                     {
                         for (uint32_t clearU = 0; clearU < width; clearU++)
                         {
-                            mask.at(static_cast<size_t>(u + clearU) + static_cast<size_t>(uLength) * static_cast<size_t>(v + clearV)) = BlockType::Air;
+                            mask.at(static_cast<size_t>(u + clearU) + static_cast<size_t>(uLength) * static_cast<size_t>(v + clearV)) = FaceMask{};
                         }
                     }
 
@@ -359,38 +425,60 @@ ChunkMesh ChunkMesher::mesh(const Chunk &chunk, const ChunkBlockProvider &blocks
     ChunkMesh mesh{};
     mesh.coord = chunk.coord();
     mesh.lodStep = step;
-    mesh.vertices.reserve(512);
-    mesh.indices.reserve(768);
+    mesh.quads.reserve(256);
 
-    std::vector<BlockType> lodBlocks(static_cast<size_t>(lodWidth) * static_cast<size_t>(lodDepth) * static_cast<size_t>(lodHeight), BlockType::Air);
-    auto localIndex = [&](uint32_t x, uint32_t y, uint32_t z) {
-        return static_cast<size_t>(x) + static_cast<size_t>(lodWidth) * (static_cast<size_t>(z) + static_cast<size_t>(lodDepth) * static_cast<size_t>(y));
-    };
-
-    for (uint32_t y = 0; y < lodHeight; ++y)
-    {
-        for (uint32_t z = 0; z < lodDepth; ++z)
-        {
-            for (uint32_t x = 0; x < lodWidth; ++x)
-            {
-                lodBlocks.at(localIndex(x, y, z)) = dominantBlockInRegion(
-                    blocks,
-                    chunk.minBlockX() + static_cast<int32_t>(x * step),
-                    static_cast<int32_t>(y * step),
-                    chunk.minBlockZ() + static_cast<int32_t>(z * step),
-                    step);
-            }
-        }
-    }
+    const PaddedBlocks paddedBlocks(chunk, blocks, step);
 
     ChunkMeshingOptions sanitizedOptions = options;
     sanitizedOptions.lodStep = step;
 
-    for (uint32_t axis = 0; axis < 3; axis++)
+    /* One pass per face direction in ChunkQuad::faceDirection() order keeps every direction's quads contiguous */
+    for (uint32_t direction = 0; direction < ChunkMesh::FACE_DIRECTION_COUNT; direction++)
     {
-        appendGreedyFacesForAxis(mesh, lodBlocks, blocks, chunk, axis, true, lodWidth, lodHeight, lodDepth, sanitizedOptions);
-        appendGreedyFacesForAxis(mesh, lodBlocks, blocks, chunk, axis, false, lodWidth, lodHeight, lodDepth, sanitizedOptions);
+        mesh.directionOffsets.at(direction) = mesh.quadCount();
+        appendGreedyFacesForAxis(mesh, paddedBlocks, blocks, chunk, direction / 2, direction % 2 == 0, lodWidth, lodHeight, lodDepth, sanitizedOptions);
     }
+    mesh.directionOffsets.at(ChunkMesh::FACE_DIRECTION_COUNT) = mesh.quadCount();
 
     return mesh;
 }
+
+void ChunkMesher::expandQuad(const ChunkQuad &quad, std::span<Voxel, ChunkMesh::VERTICES_PER_QUAD> vertices)
+{
+    const uint32_t axis = quad.axis();
+    const bool isPositive = quad.isPositive();
+    const int uAxis = static_cast<int>((axis + 1) % 3);
+    const int vAxis = static_cast<int>((axis + 2) % 3);
+    const glm::uvec3 origin = quad.origin();
+
+    const std::array<uint32_t, 4> &corners = isPositive ? POSITIVE_FACE_CORNERS : NEGATIVE_FACE_CORNERS;
+    const glm::vec3 color = faceShade(axis, isPositive) * lightBrightness(quad.light());
+    const uint32_t textureLayer = static_cast<uint32_t>(blockFaceTexture(quad.block(), axis, isPositive));
+
+    for (uint32_t i = 0; i < ChunkMesh::VERTICES_PER_QUAD; i++)
+    {
+        const uint32_t corner = corners[(i + (quad.flipped() ? 1u : 0u)) % 4u];
+
+        glm::uvec3 position = origin;
+        position[uAxis] += CORNER_OFFSETS[corner][0] * quad.width();
+        position[vAxis] += CORNER_OFFSETS[corner][1] * quad.height();
+
+        /* Chunks are a whole number of blocks wide, so chunk-local texture coordinates repeat exactly like world ones */
+        glm::vec2 texCoord{ static_cast<float>(position.x), static_cast<float>(position.z) };
+        if (axis == 0)
+        {
+            texCoord = glm::vec2{ static_cast<float>(position.z), -static_cast<float>(position.y) };
+        }
+        else if (axis == 2)
+        {
+            texCoord = glm::vec2{ static_cast<float>(position.x), -static_cast<float>(position.y) };
+        }
+
+        vertices[i] = Voxel{
+            .position = glm::u8vec4{ static_cast<uint8_t>(position.x), static_cast<uint8_t>(position.y), static_cast<uint8_t>(position.z), 0 },
+            .color = color * AMBIENT_OCCLUSION_BRIGHTNESS.at(cornerAmbientOcclusion(quad.ambientOcclusion(), corner)),
+            .texCoord = texCoord,
+            .textureLayer = textureLayer,
+        };
+    }
+}
@@ -3,20 +3,94 @@
 #include "renderer/voxel.hpp"
 #include "world/chunk.hpp"
 
+#include <array>
 #include <cstdint>
 #include <glm/glm.hpp>
+#include <span>
 #include <vector>
 
+/* One greedy quad in 8 bytes, relative to the chunk's origin. vertPulled in shaders/shader.slang decodes the same layout:
+     geometry: x:6 y:7 z:6 minimum corner, then width - 1:6 and height - 1:6 along the face's u and v axes
+     surface:  face:3 (axis * 2, +1 on the negative side), block:8, light:8, AO:8 (2 bits per corner), flipped diagonal:1 */
+struct ChunkQuad
+{
+    uint32_t geometry = 0;
+    uint32_t surface = 0;
+
+    [[nodiscard]] static ChunkQuad pack
+    (
+        const glm::uvec3 &origin,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t axis,
+        const bool isPositive,
+        const BlockType block,
+        const uint8_t light,
+        const uint8_t ambientOcclusion,
+        const bool flipped
+    )
+    {
+        return ChunkQuad{
+            .geometry = origin.x | origin.y << 6u | origin.z << 13u | (width - 1) << 19u | (height - 1) << 25u,
+            .surface = (axis * 2 + (isPositive ? 0u : 1u)) | static_cast<uint32_t>(block) << 3u | static_cast<uint32_t>(light) << 11u |
+                       static_cast<uint32_t>(ambientOcclusion) << 19u | static_cast<uint32_t>(flipped) << 27u,
+        };
+    }
+
+    [[nodiscard]] glm::uvec3 origin(void) const { return glm::uvec3{ geometry & 0x3Fu, (geometry >> 6u) & 0x7Fu, (geometry >> 13u) & 0x3Fu }; }
+    [[nodiscard]] uint32_t width(void) const { return ((geometry >> 19u) & 0x3Fu) + 1; }
+    [[nodiscard]] uint32_t height(void) const { return ((geometry >> 25u) & 0x3Fu) + 1; }
+    [[nodiscard]] uint32_t axis(void) const { return (surface & 0x7u) >> 1u; }
+    [[nodiscard]] bool isPositive(void) const { return (surface & 0x1u) == 0; }
+    [[nodiscard]] uint32_t faceDirection(void) const { return surface & 0x7u; }
+    [[nodiscard]] BlockType block(void) const { return static_cast<BlockType>((surface >> 3u) & 0xFFu); }
+    [[nodiscard]] uint8_t light(void) const { return static_cast<uint8_t>((surface >> 11u) & 0xFFu); }
+    [[nodiscard]] uint8_t ambientOcclusion(void) const { return static_cast<uint8_t>((surface >> 19u) & 0xFFu); }
+    [[nodiscard]] bool flipped(void) const { return ((surface >> 27u) & 0x1u) != 0; }
+};
+
+static_assert(sizeof(ChunkQuad) == 8, "the quad buffer layout is shared with the shader");
+static_assert(Chunk::WIDTH <= 63 && Chunk::DEPTH <= 63 && Chunk::HEIGHT <= 127, "quad origins don't fit the packed layout");
+static_assert(Chunk::WIDTH <= 64 && Chunk::DEPTH <= 64 && Chunk::HEIGHT <= 64, "quad sizes don't fit the packed layout");
+
+/* Every quad is 4 vertices drawn as (0, 1, 2, 2, 3, 0), so meshes carry no indices - the renderer shares one index buffer */
 struct ChunkMesh
 {
+    static constexpr uint32_t VERTICES_PER_QUAD = 4;
+    static constexpr uint32_t INDICES_PER_QUAD = 6;
+
+    /* +X, -X, +Y, -Y, +Z, -Z - the same numbering as ChunkQuad::faceDirection() */
+    static constexpr uint32_t FACE_DIRECTION_COUNT = 6;
+
+    /* Each face lies between a solid block and air or the chunk's edge, which bounds the quad count at any LOD */
+    static constexpr uint32_t MAX_QUADS = 3 * Chunk::BLOCK_COUNT + Chunk::WIDTH * Chunk::HEIGHT + Chunk::HEIGHT * Chunk::DEPTH + Chunk::WIDTH * Chunk::DEPTH;
+
     ChunkCoord coord{};
     uint32_t lodStep = 1;
-    std::vector<Voxel> vertices{};
-    std::vector<uint32_t> indices{};
+    std::vector<ChunkQuad> quads{};
+
+    /* Quads are grouped by face direction, direction d owns quads [directionOffsets[d], directionOffsets[d + 1]) */
+    std::array<uint32_t, FACE_DIRECTION_COUNT + 1> directionOffsets{};
+
+    [[nodiscard]] uint32_t quadCount(void) const
+    {
+        return static_cast<uint32_t>(quads.size());
+    }
+
+    [[nodiscard]] uint32_t directionQuadCount(const uint32_t direction) const
+    {
+        return directionOffsets.at(direction + 1) - directionOffsets.at(direction);
+    }
 
     [[nodiscard]] bool empty(void) const
     {
-        return vertices.empty() || indices.empty();
+        return quads.empty();
+    }
+
+    /* Heap bytes the quads take up, spare capacity included */
+    [[nodiscard]] size_t memoryBytes(void) const
+    {
+        return quads.capacity() * sizeof(ChunkQuad);
     }
 };
 
@@ -26,16 +100,24 @@ public:
     virtual ~ChunkBlockProvider() = default;
 
     [[nodiscard]] virtual BlockType blockAt(const int32_t worldX, const int32_t y, const int32_t worldZ) const = 0;
+
+    /* Sky and block light packed like Chunk::packedLight(), providers without light data report open sky */
+    [[nodiscard]] virtual uint8_t lightAt(const int32_t, const int32_t, const int32_t) const
+    {
+        return static_cast<uint8_t>(Chunk::MAX_LIGHT << 4u);
+    }
 };
 
 struct ChunkMeshingOptions
 {
     uint32_t lodStep = 1;
-    glm::vec3 positionOffset{ 0.0f };
 };
 
 class ChunkMesher
 {
 public:
     [[nodiscard]] ChunkMesh mesh(const Chunk &chunk, const ChunkBlockProvider &blocks, const ChunkMeshingOptions &options = {}) const;
+
+    /* The four vertices of a quad for the vertex attribute path, identical to what vertPulled computes on the GPU */
+    static void expandQuad(const ChunkQuad &quad, std::span<Voxel, ChunkMesh::VERTICES_PER_QUAD> vertices);
 };
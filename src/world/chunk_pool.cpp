@@ -0,0 +1,47 @@
+#include "world/chunk_pool.hpp"
+
+#include <utility>
+
+std::unique_ptr<Chunk> ChunkPool::acquire(const ChunkCoord coord)
+{
+    if (m_spares.empty())
+    {
+        return std::make_unique<Chunk>(coord);
+    }
+
+    std::unique_ptr<Chunk> chunk = std::move(m_spares.back());
+    m_spares.pop_back();
+    chunk->reset(coord);
+    return chunk;
+}
+
+void ChunkPool::release(std::unique_ptr<Chunk> chunk)
+{
+    if (chunk != nullptr && m_spares.size() < m_maxSpares)
+    {
+        m_spares.push_back(std::move(chunk));
+    }
+}
+
+void ChunkPool::adopt(ChunkPool &other)
+{
+    while (!other.m_spares.empty())
+    {
+        release(std::move(other.m_spares.back()));
+        other.m_spares.pop_back();
+    }
+}
+
+void ChunkPool::setMaxSpares(const size_t count)
+{
+    m_maxSpares = count;
+    if (m_spares.size() > m_maxSpares)
+    {
+        m_spares.resize(m_maxSpares);
+    }
+}
+
+size_t ChunkPool::spareCount(void) const
+{
+    return m_spares.size();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "world/chunk.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/* Recycles chunk storage so streaming chunks in and out doesn't go back to the allocator every time. Released chunks are kept
+   as spares and handed out again by acquire(), only the sections that still hold blocks get cleared. Spares past the cap are
+   freed, so a burst of evictions that outpaces reloading still gives its memory back */
+class ChunkPool
+{
+public:
+    /* An empty, unlit chunk at coord */
+    [[nodiscard]] std::unique_ptr<Chunk> acquire(const ChunkCoord coord);
+    void release(std::unique_ptr<Chunk> chunk);
+
+    /* Takes over the other pool's spares, as far as the cap allows */
+    void adopt(ChunkPool &other);
+
+    /* Lowering the cap frees the spares past it right away */
+    void setMaxSpares(const size_t count);
+
+    [[nodiscard]] size_t spareCount(void) const;
+
+private:
+    /* Comfortably more than World reloads per frame, small next to any sensible chunk budget */
+    static constexpr size_t DEFAULT_MAX_SPARES = 16;
+
+    std::vector<std::unique_ptr<Chunk>> m_spares{};
+    size_t m_maxSpares = DEFAULT_MAX_SPARES;
+};
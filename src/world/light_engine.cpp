@@ -0,0 +1,389 @@
+#include "world/light_engine.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+void LightEngine::initialize(ChunkMap &chunks, std::span<const ChunkCoord> coords)
+{
+    begin(chunks, nullptr);
+
+    /* Sky light needs no flooding above the heightmap, and emitters seed the block light queue */
+    for (const ChunkCoord coord : coords)
+    {
+        Chunk *found = chunks.find(coord);
+        if (found == nullptr)
+        {
+            continue;
+        }
+
+        Chunk &chunk = *found;
+        chunk.clearLight();
+
+        for (uint32_t z = 0; z < Chunk::DEPTH; z++)
+        {
+            for (uint32_t x = 0; x < Chunk::WIDTH; x++)
+            {
+                for (uint32_t y = chunk.columnHeight(x, z); y < Chunk::HEIGHT; y++)
+                {
+                    chunk.setSkyLight(Chunk::index(x, y, z), Chunk::MAX_LIGHT);
+                }
+            }
+        }
+
+        const std::span<const BlockType, Chunk::BLOCK_COUNT> blocks = chunk.blocks();
+        for (uint32_t section = 0; section < Chunk::SECTION_COUNT; section++)
+        {
+            if (chunk.sectionEmpty(section))
+            {
+                continue;
+            }
+
+            const size_t sectionBegin = Chunk::index(0, section * Chunk::SECTION_HEIGHT, 0);
+            const size_t sectionEnd = sectionBegin + static_cast<size_t>(Chunk::WIDTH) * Chunk::DEPTH * Chunk::SECTION_HEIGHT;
+            for (size_t index = sectionBegin; index < sectionEnd; index++)
+            {
+                const uint8_t emission = blockLightEmission(blocks[index]);
+                if (emission == 0)
+                {
+                    continue;
+                }
+
+                const glm::ivec3 position{
+                    chunk.minBlockX() + static_cast<int32_t>(index % Chunk::WIDTH),
+                    static_cast<int32_t>(index / (Chunk::WIDTH * Chunk::DEPTH)),
+                    chunk.minBlockZ() + static_cast<int32_t>((index / Chunk::WIDTH) % Chunk::DEPTH),
+                };
+
+                chunk.setBlockLight(index, emission);
+                m_addQueue.push_back(position);
+            }
+        }
+    }
+
+    queueNeighbourBorders(coords);
+    propagateAdd(Channel::Block);
+
+    /* Sky light only spreads sideways where a taller neighbouring column could hide air under an overhang */
+    for (const ChunkCoord coord : coords)
+    {
+        const Chunk *found = chunks.find(coord);
+        if (found == nullptr)
+        {
+            continue;
+        }
+
+        const Chunk &chunk = *found;
+        for (uint32_t z = 0; z < Chunk::DEPTH; z++)
+        {
+            for (uint32_t x = 0; x < Chunk::WIDTH; x++)
+            {
+                const int32_t worldX = chunk.minBlockX() + static_cast<int32_t>(x);
+                const int32_t worldZ = chunk.minBlockZ() + static_cast<int32_t>(z);
+                const uint32_t height = chunk.columnHeight(x, z);
+                const uint32_t neighbourHeight = std::max({
+                    columnHeightAt(worldX + 1, worldZ),
+                    columnHeightAt(worldX - 1, worldZ),
+                    columnHeightAt(worldX, worldZ + 1),
+                    columnHeightAt(worldX, worldZ - 1),
+                });
+
+                for (uint32_t y = height; y < neighbourHeight; y++)
+                {
+                    m_addQueue.push_back(glm::ivec3{ worldX, static_cast<int32_t>(y), worldZ });
+                }
+            }
+        }
+    }
+
+    queueNeighbourBorders(coords);
+    propagateAdd(Channel::Sky);
+
+    end();
+}
+
+void LightEngine::update(ChunkMap &chunks, std::span<const glm::ivec3> changedBlocks, std::unordered_map<ChunkCoord, Chunk::EditSummary> &touchedChunks)
+{
+    begin(chunks, &touchedChunks);
+    relight(Channel::Sky, changedBlocks);
+    relight(Channel::Block, changedBlocks);
+    end();
+}
+
+void LightEngine::queueNeighbourBorders(std::span<const ChunkCoord> coords)
+{
+    const std::unordered_set<ChunkCoord> lit(coords.begin(), coords.end());
+
+    for (const ChunkCoord coord : coords)
+    {
+        const int32_t minX = coord.x * static_cast<int32_t>(Chunk::WIDTH);
+        const int32_t minZ = coord.z * static_cast<int32_t>(Chunk::DEPTH);
+        const int32_t maxX = minX + static_cast<int32_t>(Chunk::WIDTH) - 1;
+        const int32_t maxZ = minZ + static_cast<int32_t>(Chunk::DEPTH) - 1;
+
+        /* The row of cells just outside each side, e.g. when a chunk comes back next to chunks that stayed loaded */
+        const std::array<std::pair<ChunkCoord, glm::ivec2>, 4> sides = {{
+            { ChunkCoord{ .x = coord.x - 1, .z = coord.z }, glm::ivec2{ minX - 1, minZ } },
+            { ChunkCoord{ .x = coord.x + 1, .z = coord.z }, glm::ivec2{ maxX + 1, minZ } },
+            { ChunkCoord{ .x = coord.x, .z = coord.z - 1 }, glm::ivec2{ minX, minZ - 1 } },
+            { ChunkCoord{ .x = coord.x, .z = coord.z + 1 }, glm::ivec2{ minX, maxZ + 1 } },
+        }};
+
+        for (size_t side = 0; side < sides.size(); side++)
+        {
+            const auto &[neighbour, start] = sides[side];
+            if (lit.contains(neighbour) || !m_chunks->contains(neighbour))
+            {
+                continue;
+            }
+
+            const bool alongZ = side < 2;
+            const uint32_t length = alongZ ? Chunk::DEPTH : Chunk::WIDTH;
+            for (uint32_t i = 0; i < length; i++)
+            {
+                const int32_t x = alongZ ? start.x : start.x + static_cast<int32_t>(i);
+                const int32_t z = alongZ ? start.y + static_cast<int32_t>(i) : start.y;
+                for (uint32_t y = 0; y < Chunk::HEIGHT; y++)
+                {
+                    m_addQueue.push_back(glm::ivec3{ x, static_cast<int32_t>(y), z });
+                }
+            }
+        }
+    }
+}
+
+void LightEngine::begin(ChunkMap &chunks, std::unordered_map<ChunkCoord, Chunk::EditSummary> *touchedChunks)
+{
+    m_chunks = &chunks;
+    m_touchedChunks = touchedChunks;
+    m_cachedChunk = nullptr;
+    m_hasCachedCoord = false;
+}
+
+void LightEngine::end(void)
+{
+    m_chunks = nullptr;
+    m_touchedChunks = nullptr;
+    m_cachedChunk = nullptr;
+    m_hasCachedCoord = false;
+}
+
+Chunk *LightEngine::chunkAt(const glm::ivec3 &position, size_t &index)
+{
+    if (position.y < 0 || position.y >= static_cast<int32_t>(Chunk::HEIGHT))
+    {
+        return nullptr;
+    }
+
+    const ChunkCoord coord = Chunk::coordAt(position.x, position.z);
+    if (!m_hasCachedCoord || !(coord == m_cachedCoord))
+    {
+        m_cachedChunk = m_chunks->find(coord);
+        m_cachedCoord = coord;
+        m_hasCachedCoord = true;
+    }
+
+    if (m_cachedChunk == nullptr)
+    {
+        return nullptr;
+    }
+
+    index = Chunk::index(
+        static_cast<uint32_t>(position.x - m_cachedChunk->minBlockX()),
+        static_cast<uint32_t>(position.y),
+        static_cast<uint32_t>(position.z - m_cachedChunk->minBlockZ()));
+
+    return m_cachedChunk;
+}
+
+uint32_t LightEngine::columnHeightAt(const int32_t worldX, const int32_t worldZ)
+{
+    size_t index = 0;
+    const Chunk *chunk = chunkAt(glm::ivec3{ worldX, 0, worldZ }, index);
+    if (chunk == nullptr)
+    {
+        return 0;
+    }
+
+    return chunk->columnHeight(static_cast<uint32_t>(worldX - chunk->minBlockX()), static_cast<uint32_t>(worldZ - chunk->minBlockZ()));
+}
+
+uint8_t LightEngine::lightLevel(const Chunk &chunk, const size_t index, const Channel channel)
+{
+    return channel == Channel::Sky ? chunk.skyLight(index) : chunk.blockLight(index);
+}
+
+void LightEngine::setLightLevel(Chunk &chunk, const size_t index, const glm::ivec3 &position, const Channel channel, const uint8_t level)
+{
+    if (channel == Channel::Sky)
+    {
+        chunk.setSkyLight(index, level);
+    }
+    else
+    {
+        chunk.setBlockLight(index, level);
+    }
+
+    if (m_touchedChunks == nullptr)
+    {
+        return;
+    }
+
+    const uint32_t localX = static_cast<uint32_t>(position.x - chunk.minBlockX());
+    const uint32_t localZ = static_cast<uint32_t>(position.z - chunk.minBlockZ());
+
+    Chunk::EditSummary &summary = (*m_touchedChunks)[chunk.coord()];
+    summary.changedBlocks++;
+    summary.minX = std::min(summary.minX, localX);
+    summary.maxX = std::max(summary.maxX, localX);
+    summary.minZ = std::min(summary.minZ, localZ);
+    summary.maxZ = std::max(summary.maxZ, localZ);
+}
+
+void LightEngine::relight(const Channel channel, std::span<const glm::ivec3> changedBlocks)
+{
+    for (const glm::ivec3 &position : changedBlocks)
+    {
+        size_t index = 0;
+        Chunk *chunk = chunkAt(position, index);
+        if (chunk == nullptr)
+        {
+            continue;
+        }
+
+        const uint8_t previous = lightLevel(*chunk, index, channel);
+        if (previous > 0)
+        {
+            setLightLevel(*chunk, index, position, channel, 0);
+            m_removalQueue.push_back(RemovalNode{ .position = position, .level = previous });
+        }
+    }
+
+    propagateRemoval(channel);
+
+    for (const glm::ivec3 &position : changedBlocks)
+    {
+        size_t index = 0;
+        Chunk *chunk = chunkAt(position, index);
+        if (chunk == nullptr)
+        {
+            continue;
+        }
+
+        const BlockType block = chunk->blocks()[index];
+
+        if (channel == Channel::Block && blockLightEmission(block) > 0)
+        {
+            setLightLevel(*chunk, index, position, channel, blockLightEmission(block));
+            m_addQueue.push_back(position);
+        }
+
+        if (blocksLight(block))
+        {
+            continue;
+        }
+
+        /* Nothing above the top of the world, so the top layer is lit by the sky itself */
+        if (channel == Channel::Sky && position.y == static_cast<int32_t>(Chunk::HEIGHT) - 1)
+        {
+            setLightLevel(*chunk, index, position, channel, Chunk::MAX_LIGHT);
+            m_addQueue.push_back(position);
+        }
+
+        /* Let the surrounding light flow back into the opening */
+        for (const glm::ivec3 &direction : NEIGHBOURS)
+        {
+            m_addQueue.push_back(position + direction);
+        }
+    }
+
+    propagateAdd(channel);
+}
+
+void LightEngine::propagateRemoval(const Channel channel)
+{
+    for (size_t head = 0; head < m_removalQueue.size(); head++)
+    {
+        const RemovalNode node = m_removalQueue[head];
+
+        for (const glm::ivec3 &direction : NEIGHBOURS)
+        {
+            const glm::ivec3 neighbour = node.position + direction;
+
+            size_t index = 0;
+            Chunk *chunk = chunkAt(neighbour, index);
+            if (chunk == nullptr)
+            {
+                continue;
+            }
+
+            const uint8_t level = lightLevel(*chunk, index, channel);
+            if (level == 0)
+            {
+                continue;
+            }
+
+            const bool skyColumn = channel == Channel::Sky && direction.y < 0 && node.level == Chunk::MAX_LIGHT;
+            if (level >= node.level && !skyColumn)
+            {
+                /* Lit by something else - it re-floods the area once the removal is done */
+                m_addQueue.push_back(neighbour);
+                continue;
+            }
+
+            setLightLevel(*chunk, index, neighbour, channel, 0);
+            m_removalQueue.push_back(RemovalNode{ .position = neighbour, .level = level });
+
+            const uint8_t emission = channel == Channel::Block ? blockLightEmission(chunk->blocks()[index]) : 0;
+            if (emission > 0)
+            {
+                setLightLevel(*chunk, index, neighbour, channel, emission);
+                m_addQueue.push_back(neighbour);
+            }
+        }
+    }
+
+    m_removalQueue.clear();
+}
+
+void LightEngine::propagateAdd(const Channel channel)
+{
+    for (size_t head = 0; head < m_addQueue.size(); head++)
+    {
+        const glm::ivec3 position = m_addQueue[head];
+
+        size_t index = 0;
+        const Chunk *chunk = chunkAt(position, index);
+        if (chunk == nullptr)
+        {
+            continue;
+        }
+
+        const uint8_t level = lightLevel(*chunk, index, channel);
+        if (level <= 1)
+        {
+            continue;
+        }
+
+        for (const glm::ivec3 &direction : NEIGHBOURS)
+        {
+            const glm::ivec3 neighbour = position + direction;
+
+            size_t neighbourIndex = 0;
+            Chunk *neighbourChunk = chunkAt(neighbour, neighbourIndex);
+            if (neighbourChunk == nullptr || blocksLight(neighbourChunk->blocks()[neighbourIndex]))
+            {
+                continue;
+            }
+
+            const bool skyColumn = channel == Channel::Sky && direction.y < 0 && level == Chunk::MAX_LIGHT;
+            const uint8_t spread = skyColumn ? level : static_cast<uint8_t>(level - 1);
+            if (lightLevel(*neighbourChunk, neighbourIndex, channel) < spread)
+            {
+                setLightLevel(*neighbourChunk, neighbourIndex, neighbour, channel, spread);
+                m_addQueue.push_back(neighbour);
+            }
+        }
+    }
+
+    m_addQueue.clear();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "world/chunk.hpp"
+#include "world/chunk_map.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/* Breadth-first flood fill of sky and block light over the loaded chunks. Sky light shines straight down at full
+   strength and loses a level per step in every other direction, block light loses a level per step everywhere.
+   Opaque blocks and unloaded chunks stop light. The queues are kept between calls so edits don't reallocate them */
+class LightEngine
+{
+public:
+    /* Lights chunks from scratch: sky light down every column, then both channels are flooded out of emitters and into overhangs,
+       and in from whatever light the loaded chunks around them already hold along the shared borders */
+    void initialize(ChunkMap &chunks, std::span<const ChunkCoord> coords);
+
+    /* Re-lights around blocks that changed. Light that may have passed through or come from them is removed first, then the hole
+       is flooded again from whatever light still borders it. Every chunk with a changed light value lands in touchedChunks, along with
+       the columns the changes span - which neighbours sample them depends on their LOD, so that is left to the caller */
+    void update(ChunkMap &chunks, std::span<const glm::ivec3> changedBlocks, std::unordered_map<ChunkCoord, Chunk::EditSummary> &touchedChunks);
+
+private:
+    enum class Channel : uint8_t
+    {
+        Sky,
+        Block
+    };
+
+    struct RemovalNode
+    {
+        glm::ivec3 position{ 0 };
+        uint8_t level = 0;
+    };
+
+    static constexpr std::array<glm::ivec3, 6> NEIGHBOURS = {{
+        { 1, 0, 0 }, { -1, 0, 0 },
+        { 0, 1, 0 }, { 0, -1, 0 },
+        { 0, 0, 1 }, { 0, 0, -1 },
+    }};
+
+    /* Queues the border cells of loaded neighbours outside of coords, so their light floods back in */
+    void queueNeighbourBorders(std::span<const ChunkCoord> coords);
+
+    void begin(ChunkMap &chunks, std::unordered_map<ChunkCoord, Chunk::EditSummary> *touchedChunks);
+    void end(void);
+
+    [[nodiscard]] Chunk *chunkAt(const glm::ivec3 &position, size_t &index);
+    [[nodiscard]] uint32_t columnHeightAt(const int32_t worldX, const int32_t worldZ);
+    [[nodiscard]] static uint8_t lightLevel(const Chunk &chunk, const size_t index, const Channel channel);
+    void setLightLevel(Chunk &chunk, const size_t index, const glm::ivec3 &position, const Channel channel, const uint8_t level);
+
+    void relight(const Channel channel, std::span<const glm::ivec3> changedBlocks);
+    void propagateRemoval(const Channel channel);
+    void propagateAdd(const Channel channel);
+
+    ChunkMap *m_chunks = nullptr;
+    std::unordered_map<ChunkCoord, Chunk::EditSummary> *m_touchedChunks = nullptr;
+
+    /* Light updates walk neighbouring cells, so most lookups hit the chunk of the previous one */
+    Chunk *m_cachedChunk = nullptr;
+    ChunkCoord m_cachedCoord{};
+    bool m_hasCachedCoord = false;
+
+    std::vector<RemovalNode> m_removalQueue{};
+    std::vector<glm::ivec3> m_addQueue{};
+};
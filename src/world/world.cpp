@@ -1,104 +1,408 @@
 #include "world/world.hpp"
 
 #include "world/chunk_generator.hpp"
+#include "world/chunk_map_block_provider.hpp"
+#include "profiling/cpu_profiler.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <exception>
 #include <iterator>
+#include <limits>
+#include <stdexcept>
 #include <unordered_map>
 #include <utility>
 
 namespace
 {
-    class LoadedChunkBlockProvider final : public ChunkBlockProvider
+    [[nodiscard]] ChunkCoord startChunk(const World::GenerationSettings &settings)
     {
-    public:
-        explicit LoadedChunkBlockProvider(const std::unordered_map<ChunkCoord, Chunk> &chunks) : m_chunks(chunks){}
+        return ChunkCoord{
+            .x = -static_cast<int32_t>(std::max(1u, settings.chunkColumnsX) / 2),
+            .z = -static_cast<int32_t>(std::max(1u, settings.chunkColumnsZ) / 2),
+        };
+    }
 
-        [[nodiscard]] BlockType blockAt(const int32_t worldX, const int32_t y, const int32_t worldZ) const override
+    [[nodiscard]] uint32_t chunkLodStep(const World::GenerationSettings &settings, const ChunkCoord coord)
+    {
+        if (!settings.enableLevelOfDetail)
         {
-            if (y < 0 || y >= static_cast<int32_t>(Chunk::HEIGHT))
+            return 1;
+        }
+
+        const ChunkCoord start = startChunk(settings);
+        const float centerX = (static_cast<float>(settings.chunkColumnsX) - 1.0f) * 0.5f;
+        const float centerZ = (static_cast<float>(settings.chunkColumnsZ) - 1.0f) * 0.5f;
+        const float dx = static_cast<float>(coord.x - start.x) - centerX;
+        const float dz = static_cast<float>(coord.z - start.z) - centerZ;
+        const float distance = std::sqrt(dx * dx + dz * dz);
+
+        if (distance >= 10.0f)
+        {
+            return 4;
+        }
+
+        if (distance >= 5.0f)
+        {
+            return 2;
+        }
+
+        return 1;
+    }
+
+    /* Walks the voxel grid cell by cell, except where a whole box of cells is known to be empty - those are left in one jump */
+    [[nodiscard]] std::optional<World::RaycastHit> traceRay(const ChunkMap &chunks, const glm::vec3 &origin, const glm::vec3 &direction, const float maxDistance)
+    {
+        const float directionLength = glm::length(direction);
+        if (!(directionLength > 0.0f) || !(maxDistance > 0.0f))
+        {
+            return std::nullopt;
+        }
+
+        constexpr float infinity = std::numeric_limits<float>::infinity();
+        constexpr int32_t width = static_cast<int32_t>(Chunk::WIDTH);
+        constexpr int32_t depth = static_cast<int32_t>(Chunk::DEPTH);
+        constexpr int32_t height = static_cast<int32_t>(Chunk::HEIGHT);
+        constexpr int32_t sectionHeight = static_cast<int32_t>(Chunk::SECTION_HEIGHT);
+
+        /* Far enough to never be reached, small enough to survive the conversion to float */
+        constexpr int32_t unbounded = 1 << 24;
+
+        const glm::vec3 dir = direction / directionLength;
+
+        glm::ivec3 step{ 0 };
+        glm::vec3 tDelta{ infinity };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (dir[axis] > 0.0f)
+            {
+                step[axis] = 1;
+                tDelta[axis] = 1.0f / dir[axis];
+            }
+            else if (dir[axis] < 0.0f)
             {
-                return BlockType::Air;
+                step[axis] = -1;
+                tDelta[axis] = -1.0f / dir[axis];
             }
+        }
 
-            const ChunkCoord coord = {
-                .x = floorDiv(worldX, static_cast<int32_t>(Chunk::WIDTH)),
-                .z = floorDiv(worldZ, static_cast<int32_t>(Chunk::DEPTH)),
-            };
+        /* All distances are measured from the origin, so re-seeding the traversal after a jump doesn't accumulate error */
+        auto planeDistance = [&](const int axis, const int32_t plane)
+        {
+            return (static_cast<float>(plane) - origin[axis]) / dir[axis];
+        };
 
-            const auto it = m_chunks.find(coord);
-            if (it == m_chunks.end())
+        glm::ivec3 cell{
+            static_cast<int32_t>(std::floor(origin.x)),
+            static_cast<int32_t>(std::floor(origin.y)),
+            static_cast<int32_t>(std::floor(origin.z)),
+        };
+
+        glm::vec3 tMax{ infinity };
+        auto seedTraversal = [&]()
+        {
+            for (int axis = 0; axis < 3; axis++)
             {
-                return BlockType::Air;
+                if (step[axis] != 0)
+                {
+                    tMax[axis] = planeDistance(axis, step[axis] > 0 ? cell[axis] + 1 : cell[axis]);
+                }
             }
+        };
+        seedTraversal();
 
-            const uint32_t localX = static_cast<uint32_t>(worldX - coord.x * static_cast<int32_t>(Chunk::WIDTH));
-            const uint32_t localZ = static_cast<uint32_t>(worldZ - coord.z * static_cast<int32_t>(Chunk::DEPTH));
-            return it->second.get(localX, static_cast<uint32_t>(y), localZ);
-        }
+        float distance = 0.0f;
+        int enteredAxis = -1;
 
-    private:
-        [[nodiscard]] static int32_t floorDiv(const int32_t value, const int32_t divisor)
+        const Chunk *chunk = nullptr;
+        ChunkCoord cachedCoord{};
+        bool hasCachedCoord = false;
+
+        while (distance <= maxDistance)
         {
-            int32_t result = value / divisor;
-            
-            const int32_t remainder = value % divisor;
-            
-            if (remainder != 0 && ((remainder < 0) != (divisor < 0)))
+            if ((cell.y < 0 && step.y <= 0) || (cell.y >= height && step.y >= 0))
+            {
+                return std::nullopt;
+            }
+
+            const ChunkCoord coord = Chunk::coordAt(cell.x, cell.z);
+            if (!hasCachedCoord || !(coord == cachedCoord))
+            {
+                chunk = chunks.find(coord);
+                cachedCoord = coord;
+                hasCachedCoord = true;
+            }
+
+            /* Start with the whole chunk column as the empty box and shrink it to what we actually know is empty */
+            glm::ivec3 boxMin{ coord.x * width, 0, coord.z * depth };
+            glm::ivec3 boxMax{ boxMin.x + width, height, boxMin.z + depth };
+            bool emptyBox = true;
+
+            if (cell.y < 0)
+            {
+                boxMin.y = -unbounded;
+                boxMax.y = 0;
+            }
+            else if (cell.y >= height)
             {
-                --result;
+                boxMin.y = height;
+                boxMax.y = unbounded;
             }
+            else if (chunk != nullptr)
+            {
+                const uint32_t localX = static_cast<uint32_t>(cell.x - boxMin.x);
+                const uint32_t localY = static_cast<uint32_t>(cell.y);
+                const uint32_t localZ = static_cast<uint32_t>(cell.z - boxMin.z);
+                const uint32_t section = localY / Chunk::SECTION_HEIGHT;
+                const int32_t columnHeight = static_cast<int32_t>(chunk->columnHeight(localX, localZ));
+
+                if (chunk->sectionEmpty(section))
+                {
+                    boxMin.y = static_cast<int32_t>(section) * sectionHeight;
+                    boxMax.y = boxMin.y + sectionHeight;
+                }
+                else if (cell.y >= columnHeight)
+                {
+                    boxMin = glm::ivec3{ cell.x, columnHeight, cell.z };
+                    boxMax = glm::ivec3{ cell.x + 1, height, cell.z + 1 };
+                }
+                else
+                {
+                    const BlockType block = chunk->blocks()[Chunk::index(localX, localY, localZ)];
+                    if (block != BlockType::Air)
+                    {
+                        World::RaycastHit hit{};
+                        hit.block = cell;
+                        hit.distance = distance;
+                        hit.type = block;
+                        if (enteredAxis >= 0)
+                        {
+                            hit.normal[enteredAxis] = -step[enteredAxis];
+                        }
+
+                        return hit;
+                    }
 
-            return result;
+                    emptyBox = false;
+                }
+            }
+
+            if (!emptyBox)
+            {
+                int axis = 0;
+                if (tMax.y < tMax[axis])
+                {
+                    axis = 1;
+                }
+
+                if (tMax.z < tMax[axis])
+                {
+                    axis = 2;
+                }
+
+                distance = tMax[axis];
+                cell[axis] += step[axis];
+                tMax[axis] += tDelta[axis];
+                enteredAxis = axis;
+                continue;
+            }
+
+            int exitAxis = -1;
+            float exitDistance = infinity;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (step[axis] == 0)
+                {
+                    continue;
+                }
+
+                const float boundaryDistance = planeDistance(axis, step[axis] > 0 ? boxMax[axis] : boxMin[axis]);
+                if (boundaryDistance < exitDistance)
+                {
+                    exitDistance = boundaryDistance;
+                    exitAxis = axis;
+                }
+            }
+
+            distance = std::max(distance, exitDistance);
+
+            /* Land in the first cell past the box, clamping the other axes so rounding can never skip a cell */
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (axis == exitAxis)
+                {
+                    cell[axis] = step[axis] > 0 ? boxMax[axis] : boxMin[axis] - 1;
+                }
+                else
+                {
+                    const int32_t landing = static_cast<int32_t>(std::floor(origin[axis] + dir[axis] * distance));
+                    cell[axis] = std::clamp(landing, boxMin[axis], boxMax[axis] - 1);
+                }
+            }
+
+            enteredAxis = exitAxis;
+            seedTraversal();
         }
 
-        const std::unordered_map<ChunkCoord, Chunk> &m_chunks;
-    };
+        return std::nullopt;
+    }
 
-    [[nodiscard]] uint32_t chunkLodStep(const World::GenerationSettings &settings, uint32_t columnX, uint32_t columnZ)
+    /* Resolves solid blocks by reading chunk storage directly, caching the chunk of the last column it looked at */
+    class SolidBlockLookup
     {
-        if (!settings.enableLevelOfDetail)
+    public:
+        explicit SolidBlockLookup(const ChunkMap &chunks) : m_chunks(chunks){}
+
+        [[nodiscard]] bool solid(const int32_t x, const int32_t y, const int32_t z)
         {
-            return 1;
+            if (y < 0 || y >= static_cast<int32_t>(Chunk::HEIGHT))
+            {
+                return false;
+            }
+
+            const ChunkCoord coord = Chunk::coordAt(x, z);
+            if (!m_hasCachedCoord || !(coord == m_cachedCoord))
+            {
+                m_chunk = m_chunks.find(coord);
+                m_cachedCoord = coord;
+                m_hasCachedCoord = true;
+            }
+
+            if (m_chunk == nullptr)
+            {
+                return false;
+            }
+
+            const uint32_t localX = static_cast<uint32_t>(x - m_chunk->minBlockX());
+            const uint32_t localZ = static_cast<uint32_t>(z - m_chunk->minBlockZ());
+            return m_chunk->blocks()[Chunk::index(localX, static_cast<uint32_t>(y), localZ)] != BlockType::Air;
         }
 
-        const float centerX = (static_cast<float>(settings.chunkColumnsX) - 1.0f) * 0.5f;
-        const float centerZ = (static_cast<float>(settings.chunkColumnsZ) - 1.0f) * 0.5f;
-        const float dx = static_cast<float>(columnX) - centerX;
-        const float dz = static_cast<float>(columnZ) - centerZ;
-        const float distance = std::sqrt(dx * dx + dz * dz);
+    private:
+        const ChunkMap &m_chunks;
+        const Chunk *m_chunk = nullptr;
+        ChunkCoord m_cachedCoord{};
+        bool m_hasCachedCoord = false;
+    };
 
-        if (distance >= 10.0f)
+    /* Boxes that merely touch a block face don't count as overlapping it */
+    constexpr float COLLISION_EPSILON = 1e-4f;
+
+    [[nodiscard]] int32_t firstCell(const float min)
+    {
+        return static_cast<int32_t>(std::floor(min + COLLISION_EPSILON));
+    }
+
+    [[nodiscard]] int32_t lastCell(const float max)
+    {
+        return static_cast<int32_t>(std::ceil(max - COLLISION_EPSILON)) - 1;
+    }
+
+    [[nodiscard]] bool boxIntersectsSolid(SolidBlockLookup &lookup, const World::Aabb &box)
+    {
+        for (int32_t x = firstCell(box.min.x); x <= lastCell(box.max.x); x++)
         {
-            return 4;
+            for (int32_t z = firstCell(box.min.z); z <= lastCell(box.max.z); z++)
+            {
+                for (int32_t y = firstCell(box.min.y); y <= lastCell(box.max.y); y++)
+                {
+                    if (lookup.solid(x, y, z))
+                    {
+                        return true;
+                    }
+                }
+            }
         }
 
-        if (distance >= 5.0f)
+        return false;
+    }
+
+    [[nodiscard]] World::SweepResult sweepBox(const ChunkMap &chunks, World::Aabb box, const glm::vec3 &motion)
+    {
+        constexpr std::array<int, 3> axisOrder = { 1, 0, 2 };
+
+        SolidBlockLookup lookup(chunks);
+        World::SweepResult result{};
+
+        for (const int axis : axisOrder)
         {
-            return 2;
+            float delta = motion[axis];
+            if (delta == 0.0f)
+            {
+                continue;
+            }
+
+            const int uAxis = (axis + 1) % 3;
+            const int vAxis = (axis + 2) % 3;
+            const int32_t uFirst = firstCell(box.min[uAxis]);
+            const int32_t uLast = lastCell(box.max[uAxis]);
+            const int32_t vFirst = firstCell(box.min[vAxis]);
+            const int32_t vLast = lastCell(box.max[vAxis]);
+
+            /* Only the layers of cells in front of the leading face, nearest first */
+            const bool positive = delta > 0.0f;
+            const int32_t layerStep = positive ? 1 : -1;
+            const int32_t firstLayer = positive ? lastCell(box.max[axis]) + 1 : firstCell(box.min[axis]) - 1;
+            const int32_t lastLayer = positive ? lastCell(box.max[axis] + delta) : firstCell(box.min[axis] + delta);
+
+            bool blocked = false;
+            for (int32_t layer = firstLayer; positive ? layer <= lastLayer : layer >= lastLayer; layer += layerStep)
+            {
+                for (int32_t u = uFirst; u <= uLast && !blocked; u++)
+                {
+                    for (int32_t v = vFirst; v <= vLast && !blocked; v++)
+                    {
+                        glm::ivec3 cell{ 0 };
+                        cell[axis] = layer;
+                        cell[uAxis] = u;
+                        cell[vAxis] = v;
+                        blocked = lookup.solid(cell.x, cell.y, cell.z);
+                    }
+                }
+
+                if (blocked)
+                {
+                    delta = positive
+                        ? std::clamp(static_cast<float>(layer) - box.max[axis], 0.0f, delta)
+                        : std::clamp(static_cast<float>(layer + 1) - box.min[axis], delta, 0.0f);
+                    break;
+                }
+            }
+
+            box.min[axis] += delta;
+            box.max[axis] += delta;
+            result.motion[axis] = delta;
+            result.collided[axis] = blocked;
         }
 
-        return 1;
+        return result;
     }
 
-    void appendChunkMesh(World::Mesh &target, ChunkMesh source)
+    void appendBlockPositions(const Chunk &chunk, std::span<const uint32_t> indices, std::vector<glm::ivec3> &positions)
     {
-        const uint32_t baseIndex = static_cast<uint32_t>(target.vertices.size());
-        target.vertices.insert(target.vertices.end(), std::make_move_iterator(source.vertices.begin()), std::make_move_iterator(source.vertices.end()));
-        target.indices.reserve(target.indices.size() + source.indices.size());
-
-        for (const uint32_t index : source.indices)
+        for (const uint32_t index : indices)
         {
-            target.indices.push_back(baseIndex + index);
+            positions.push_back(glm::ivec3{
+                chunk.minBlockX() + static_cast<int32_t>(index % Chunk::WIDTH),
+                static_cast<int32_t>(index / (Chunk::WIDTH * Chunk::DEPTH)),
+                chunk.minBlockZ() + static_cast<int32_t>((index / Chunk::WIDTH) % Chunk::DEPTH),
+            });
         }
     }
+
+    [[nodiscard]] ChunkMeshingOptions chunkMeshingOptions(const World::GenerationSettings &settings, const ChunkCoord coord)
+    {
+        return ChunkMeshingOptions{
+            .lodStep = chunkLodStep(settings, coord),
+        };
+    }
 }
 
 World::~World()
 {
     joinGenerationThread();
+    stopMeshWorkers();
 }
 
 /* TODO: max height? */
@@ -109,9 +413,7 @@ void World::generateTerrain(const uint32_t width, const uint32_t depth)
     settings.chunkColumnsZ = std::max(1u, (depth + CHUNK_DEPTH - 1) / CHUNK_DEPTH);
     settings.enableLevelOfDetail = false;
 
-    Mesh mesh = generateChunkedTerrain(settings);
-    vertices = std::move(mesh.vertices);
-    indices = std::move(mesh.indices);
+    publishTerrain(settings, generateChunkedTerrain(settings));
 }
 
 void World::requestChunkGeneration(const GenerationSettings &settings)
@@ -125,13 +427,11 @@ void World::requestChunkGeneration(const GenerationSettings &settings)
     m_generating.store(true);
 
     m_generationThread = std::thread([this, settings]() {
+        CpuProfiler::setThreadName("World generation");
+
         try
         {
-            Mesh mesh = generateChunkedTerrain(settings);
-            {
-                std::lock_guard lock(m_meshMutex);
-                m_pendingMesh = std::move(mesh);
-            }
+            publishTerrain(settings, generateChunkedTerrain(settings));
         }
         catch (const std::exception &)
         {
@@ -141,16 +441,17 @@ void World::requestChunkGeneration(const GenerationSettings &settings)
     });
 }
 
-bool World::consumeGeneratedMesh(Mesh &mesh)
+bool World::consumeChunkMeshes(std::vector<Mesh> &meshes)
 {
     std::lock_guard lock(m_meshMutex);
-    if (!m_pendingMesh.has_value())
+    if (m_readyMeshes.empty())
     {
         return false;
     }
 
-    mesh = std::move(*m_pendingMesh);
-    m_pendingMesh.reset();
+    meshes = std::move(m_readyMeshes);
+    m_readyMeshes.clear();
+    m_readyMeshBytes = 0;
     return true;
 }
 
@@ -159,6 +460,426 @@ bool World::isGenerating(void) const
     return m_generating.load();
 }
 
+World::MemoryStats World::memoryStats(void) const
+{
+    MemoryStats stats{};
+    {
+        std::shared_lock lock(m_chunkMutex);
+        stats.chunkCount = m_chunks.size();
+        stats.chunkBytes = m_chunks.memoryBytes();
+        stats.peakChunkBytes = m_peakChunkBytes;
+        stats.evictedChunkCount = m_evictedChunks.size();
+    }
+
+    std::lock_guard lock(m_meshMutex);
+    stats.meshBytes = m_readyMeshBytes;
+    stats.peakMeshBytes = m_peakMeshBytes;
+    return stats;
+}
+
+BlockType World::getBlock(const int32_t worldX, const int32_t y, const int32_t worldZ) const
+{
+    std::shared_lock lock(m_chunkMutex);
+    return ChunkMapBlockProvider(m_chunks).blockAt(worldX, y, worldZ);
+}
+
+bool World::setBlock(const int32_t worldX, const int32_t y, const int32_t worldZ, const BlockType block)
+{
+    if (y < 0 || y >= static_cast<int32_t>(CHUNK_HEIGHT))
+    {
+        return false;
+    }
+
+    const ChunkCoord coord = Chunk::coordAt(worldX, worldZ);
+    const uint32_t localX = static_cast<uint32_t>(worldX - coord.x * static_cast<int32_t>(CHUNK_WIDTH));
+    const uint32_t localZ = static_cast<uint32_t>(worldZ - coord.z * static_cast<int32_t>(CHUNK_DEPTH));
+
+    std::unique_lock lock(m_chunkMutex);
+
+    Chunk *chunk = m_chunks.find(coord);
+    if (chunk == nullptr)
+    {
+        return false;
+    }
+
+    if (chunk->get(localX, static_cast<uint32_t>(y), localZ) == block)
+    {
+        return true;
+    }
+
+    chunk->set(localX, static_cast<uint32_t>(y), localZ, block);
+    markEditedChunkDirty(coord, Chunk::EditSummary{
+        .changedBlocks = 1,
+        .minX = localX,
+        .maxX = localX,
+        .minZ = localZ,
+        .maxZ = localZ,
+    });
+
+    const glm::ivec3 changedBlock{ worldX, y, worldZ };
+    relightBlocks(std::span(&changedBlock, 1));
+
+    return true;
+}
+
+uint32_t World::applyEdits(std::span<const BlockEdit> edits)
+{
+    struct BucketedEdit
+    {
+        ChunkCoord coord{};
+        ChunkBlockEdit edit{};
+    };
+
+    std::vector<BucketedEdit> bucketed;
+    bucketed.reserve(edits.size());
+
+    for (const BlockEdit &edit : edits)
+    {
+        if (edit.y < 0 || edit.y >= static_cast<int32_t>(CHUNK_HEIGHT))
+        {
+            continue;
+        }
+
+        const ChunkCoord coord = Chunk::coordAt(edit.x, edit.z);
+        const uint32_t localX = static_cast<uint32_t>(edit.x - coord.x * static_cast<int32_t>(CHUNK_WIDTH));
+        const uint32_t localZ = static_cast<uint32_t>(edit.z - coord.z * static_cast<int32_t>(CHUNK_DEPTH));
+
+        bucketed.push_back(BucketedEdit{
+            .coord = coord,
+            .edit = ChunkBlockEdit{
+                .index = static_cast<uint32_t>(Chunk::index(localX, static_cast<uint32_t>(edit.y), localZ)),
+                .block = edit.block,
+            },
+        });
+    }
+
+    /* Stable, so repeated edits to one block keep their order inside the chunk's group */
+    std::stable_sort(bucketed.begin(), bucketed.end(), [](const BucketedEdit &lhs, const BucketedEdit &rhs) {
+        return lhs.coord.x != rhs.coord.x ? lhs.coord.x < rhs.coord.x : lhs.coord.z < rhs.coord.z;
+    });
+
+    std::vector<ChunkBlockEdit> group;
+    std::vector<uint32_t> changedIndices;
+    std::vector<glm::ivec3> changedPositions;
+    uint32_t changedBlocks = 0;
+
+    std::unique_lock lock(m_chunkMutex);
+
+    for (size_t begin = 0; begin < bucketed.size();)
+    {
+        const ChunkCoord coord = bucketed.at(begin).coord;
+
+        size_t end = begin;
+        group.clear();
+        while (end < bucketed.size() && bucketed.at(end).coord == coord)
+        {
+            group.push_back(bucketed.at(end).edit);
+            ++end;
+        }
+
+        Chunk *chunk = m_chunks.find(coord);
+        if (chunk != nullptr)
+        {
+            changedIndices.clear();
+            const Chunk::EditSummary summary = chunk->apply(group, &changedIndices);
+            markEditedChunkDirty(coord, summary);
+            changedBlocks += summary.changedBlocks;
+            appendBlockPositions(*chunk, changedIndices, changedPositions);
+        }
+
+        begin = end;
+    }
+
+    relightBlocks(changedPositions);
+
+    return changedBlocks;
+}
+
+uint32_t World::fillRegion(const int32_t minX, const int32_t minY, const int32_t minZ, const int32_t maxX, const int32_t maxY, const int32_t maxZ, const BlockType block)
+{
+    const int32_t clampedMinY = std::max(minY, 0);
+    const int32_t clampedMaxY = std::min(maxY, static_cast<int32_t>(CHUNK_HEIGHT) - 1);
+    if (minX > maxX || minZ > maxZ || clampedMinY > clampedMaxY)
+    {
+        return 0;
+    }
+
+    const ChunkCoord minChunk = Chunk::coordAt(minX, minZ);
+    const ChunkCoord maxChunk = Chunk::coordAt(maxX, maxZ);
+    std::vector<uint32_t> changedIndices;
+    std::vector<glm::ivec3> changedPositions;
+    uint32_t changedBlocks = 0;
+
+    std::unique_lock lock(m_chunkMutex);
+
+    for (int32_t chunkZ = minChunk.z; chunkZ <= maxChunk.z; chunkZ++)
+    {
+        for (int32_t chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
+        {
+            const ChunkCoord coord = { .x = chunkX, .z = chunkZ };
+            Chunk *chunk = m_chunks.find(coord);
+            if (chunk == nullptr)
+            {
+                continue;
+            }
+
+            const int32_t originX = chunk->minBlockX();
+            const int32_t originZ = chunk->minBlockZ();
+            const Chunk::EditSummary summary = chunk->fill(
+                static_cast<uint32_t>(std::max(minX, originX) - originX),
+                static_cast<uint32_t>(clampedMinY),
+                static_cast<uint32_t>(std::max(minZ, originZ) - originZ),
+                static_cast<uint32_t>(std::min(maxX, originX + static_cast<int32_t>(CHUNK_WIDTH) - 1) - originX),
+                static_cast<uint32_t>(clampedMaxY),
+                static_cast<uint32_t>(std::min(maxZ, originZ + static_cast<int32_t>(CHUNK_DEPTH) - 1) - originZ),
+                block,
+                &changedIndices);
+
+            markEditedChunkDirty(coord, summary);
+            changedBlocks += summary.changedBlocks;
+            appendBlockPositions(*chunk, changedIndices, changedPositions);
+            changedIndices.clear();
+        }
+    }
+
+    relightBlocks(changedPositions);
+
+    return changedBlocks;
+}
+
+std::optional<World::RaycastHit> World::raycast(const glm::vec3 &origin, const glm::vec3 &direction, const float maxDistance) const
+{
+    std::shared_lock lock(m_chunkMutex);
+    return traceRay(m_chunks, origin, direction, maxDistance);
+}
+
+void World::raycast(std::span<const Ray> rays, std::span<std::optional<RaycastHit>> hits) const
+{
+    if (hits.size() < rays.size())
+    {
+        throw std::invalid_argument("World::raycast(): hits must have room for every ray");
+    }
+
+    std::shared_lock lock(m_chunkMutex);
+    for (size_t i = 0; i < rays.size(); i++)
+    {
+        hits[i] = traceRay(m_chunks, rays[i].origin, rays[i].direction, rays[i].maxDistance);
+    }
+}
+
+World::SweepResult World::sweepAabb(const Aabb &box, const glm::vec3 &motion) const
+{
+    std::shared_lock lock(m_chunkMutex);
+    return sweepBox(m_chunks, box, motion);
+}
+
+void World::sweepAabb(std::span<const Aabb> boxes, std::span<const glm::vec3> motions, std::span<SweepResult> results) const
+{
+    if (motions.size() < boxes.size() || results.size() < boxes.size())
+    {
+        throw std::invalid_argument("World::sweepAabb(): every box needs a motion and a result");
+    }
+
+    std::shared_lock lock(m_chunkMutex);
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        results[i] = sweepBox(m_chunks, boxes[i], motions[i]);
+    }
+}
+
+bool World::intersectsSolid(const Aabb &box) const
+{
+    std::shared_lock lock(m_chunkMutex);
+    SolidBlockLookup lookup(m_chunks);
+    return boxIntersectsSolid(lookup, box);
+}
+
+void World::flushDirtyChunks(void)
+{
+    const CpuProfiler::Zone zone("World::flushDirtyChunks");
+
+    std::unique_lock chunkLock(m_chunkMutex);
+    if (m_dirtyChunks.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard jobLock(m_jobMutex);
+
+        for (auto it = m_dirtyChunks.begin(); it != m_dirtyChunks.end();)
+        {
+            /* A chunk that is still being meshed stays dirty until its worker is done, so results can't arrive out of order */
+            if (m_meshingChunks.contains(*it))
+            {
+                ++it;
+                continue;
+            }
+
+            Chunk *chunk = m_chunks.find(*it);
+            if (chunk != nullptr)
+            {
+                chunk->clearDirty();
+                m_meshingChunks.insert(*it);
+                m_meshJobs.push_back(*it);
+            }
+
+            it = m_dirtyChunks.erase(it);
+        }
+    }
+
+    chunkLock.unlock();
+
+    startMeshWorkers();
+    m_jobCondition.notify_all();
+}
+
+void World::setMemoryBudget(const MemoryBudget &budget)
+{
+    std::unique_lock lock(m_chunkMutex);
+    m_memoryBudget = budget;
+}
+
+void World::updateResidency(const glm::vec3 &focus)
+{
+    const CpuProfiler::Zone zone("World::updateResidency");
+
+    const float focusX = focus.x / static_cast<float>(CHUNK_WIDTH);
+    const float focusZ = focus.z / static_cast<float>(CHUNK_DEPTH);
+
+    /* Distance in chunks from the focus to the chunk's centre */
+    auto distance = [&](const ChunkCoord coord)
+    {
+        const float dx = static_cast<float>(coord.x) + 0.5f - focusX;
+        const float dz = static_cast<float>(coord.z) + 0.5f - focusZ;
+        return std::sqrt(dx * dx + dz * dz);
+    };
+
+    /* Worked out under the shared lock, so the frames with nothing to do don't stall behind the mesh workers */
+    std::vector<ChunkCoord> reloads;
+    std::vector<ChunkCoord> evictions;
+    {
+        std::shared_lock lock(m_chunkMutex);
+        const float residentRadius = static_cast<float>(m_memoryBudget.residentRadius);
+
+        for (const ChunkCoord coord : m_evictedChunks)
+        {
+            if (reloads.size() == MAX_RELOADS_PER_UPDATE)
+            {
+                break;
+            }
+
+            if (distance(coord) <= residentRadius)
+            {
+                reloads.push_back(coord);
+            }
+        }
+
+        if (m_memoryBudget.chunkBytes != 0 && m_chunks.loadedBytes() > m_memoryBudget.chunkBytes)
+        {
+            std::vector<std::pair<float, ChunkCoord>> candidates;
+            {
+                std::lock_guard jobLock(m_jobMutex);
+                for (const auto &[coord, chunk] : m_chunks)
+                {
+                    const float chunkDistance = distance(coord);
+                    if (chunkDistance > residentRadius && !pinned(coord))
+                    {
+                        candidates.emplace_back(chunkDistance, coord);
+                    }
+                }
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+            for (const auto &[chunkDistance, coord] : candidates)
+            {
+                evictions.push_back(coord);
+            }
+        }
+    }
+
+    if (reloads.empty() && evictions.empty())
+    {
+        return;
+    }
+
+    /* Regeneration runs on this thread under the exclusive lock, so only a few chunks come back per frame */
+    std::unique_lock lock(m_chunkMutex);
+    for (const ChunkCoord coord : reloads)
+    {
+        if (m_evictedChunks.contains(coord))
+        {
+            reloadChunk(coord);
+        }
+    }
+
+    /* Evicted storage goes to the map's pool, where the next reload picks it up instead of allocating */
+    std::lock_guard jobLock(m_jobMutex);
+    for (const ChunkCoord coord : evictions)
+    {
+        if (m_memoryBudget.chunkBytes == 0 || m_chunks.loadedBytes() <= m_memoryBudget.chunkBytes)
+        {
+            break;
+        }
+
+        /* The lock was let go in between, the chunk may have been edited or queued for meshing since */
+        if (!m_chunks.contains(coord) || pinned(coord))
+        {
+            continue;
+        }
+
+        m_chunks.erase(coord);
+        m_evictedChunks.insert(coord);
+    }
+}
+
+bool World::pinned(const ChunkCoord coord) const
+{
+    return m_editedChunks.contains(coord) || m_dirtyChunks.contains(coord) || m_meshingChunks.contains(coord);
+}
+
+void World::requestMeshes(std::span<const ChunkCoord> coords)
+{
+    {
+        std::unique_lock lock(m_chunkMutex);
+        for (const ChunkCoord coord : coords)
+        {
+            if (m_evictedChunks.contains(coord))
+            {
+                reloadChunk(coord);
+            }
+
+            markChunkDirty(coord);
+        }
+    }
+
+    flushDirtyChunks();
+}
+
+void World::reloadChunk(const ChunkCoord coord)
+{
+    const CpuProfiler::Zone zone("World::reloadChunk");
+
+    const ChunkGenerator generator(m_settings.seed);
+    generator.generate(m_chunks.emplace(coord));
+    m_peakChunkBytes = std::max(m_peakChunkBytes, m_chunks.memoryBytes());
+    m_evictedChunks.erase(coord);
+
+    m_lightEngine.initialize(m_chunks, std::span(&coord, 1));
+
+    /* Neighbours meshed while it was gone saw air along the shared border, the diagonal ones in the corner cells they read for AO */
+    for (int32_t dz = -1; dz <= 1; dz++)
+    {
+        for (int32_t dx = -1; dx <= 1; dx++)
+        {
+            if (dx != 0 || dz != 0)
+            {
+                markChunkDirty(ChunkCoord{ .x = coord.x + dx, .z = coord.z + dz });
+            }
+        }
+    }
+}
+
 void World::joinGenerationThread(void)
 {
     if (m_generationThread.joinable())
@@ -167,16 +888,42 @@ void World::joinGenerationThread(void)
     }
 }
 
-World::Mesh World::generateChunkedTerrain(const GenerationSettings &settings)
+void World::publishTerrain(const GenerationSettings &settings, GeneratedTerrain terrain)
+{
+    {
+        std::unique_lock lock(m_chunkMutex);
+
+        /* The old chunks' storage carries over to the new map as spares, for the reloads that follow */
+        m_chunks.clear();
+        terrain.chunks.adoptSpares(m_chunks);
+        m_chunks = std::move(terrain.chunks);
+        m_peakChunkBytes = std::max(m_peakChunkBytes, m_chunks.memoryBytes());
+        m_settings = settings;
+        m_dirtyChunks.clear();
+        m_evictedChunks.clear();
+        m_editedChunks.clear();
+    }
+
+    std::lock_guard lock(m_meshMutex);
+    for (const Mesh &mesh : terrain.meshes)
+    {
+        m_readyMeshBytes += mesh.memoryBytes();
+    }
+    m_peakMeshBytes = std::max(m_peakMeshBytes, m_readyMeshBytes);
+    m_readyMeshes.insert(m_readyMeshes.end(), std::make_move_iterator(terrain.meshes.begin()), std::make_move_iterator(terrain.meshes.end()));
+}
+
+World::GeneratedTerrain World::generateChunkedTerrain(const GenerationSettings &settings)
 {
+    const CpuProfiler::Zone zone("World::generateChunkedTerrain");
+
     const uint32_t chunkColumnsX = std::max(1u, settings.chunkColumnsX);
     const uint32_t chunkColumnsZ = std::max(1u, settings.chunkColumnsZ);
 
-    const int32_t startChunkX = -static_cast<int32_t>(chunkColumnsX / 2);
-    const int32_t startChunkZ = -static_cast<int32_t>(chunkColumnsZ / 2);
+    const ChunkCoord start = startChunk(settings);
 
-    std::unordered_map<ChunkCoord, Chunk> chunks;
-    chunks.reserve(static_cast<size_t>(chunkColumnsX) * static_cast<size_t>(chunkColumnsZ));
+    GeneratedTerrain terrain{};
+    terrain.chunks.reserve(static_cast<size_t>(chunkColumnsX) * static_cast<size_t>(chunkColumnsZ));
 
     ChunkGenerator generator(settings.seed);
 
@@ -185,44 +932,227 @@ World::Mesh World::generateChunkedTerrain(const GenerationSettings &settings)
         for (uint32_t columnX = 0; columnX < chunkColumnsX; columnX++)
         {
             const ChunkCoord coord{
-                .x = startChunkX + static_cast<int32_t>(columnX),
-                .z = startChunkZ + static_cast<int32_t>(columnZ),
+                .x = start.x + static_cast<int32_t>(columnX),
+                .z = start.z + static_cast<int32_t>(columnZ),
             };
 
-            chunks.emplace(coord, generator.generate(coord));
+            const CpuProfiler::Zone generateZone("ChunkGenerator::generate");
+            generator.generate(terrain.chunks.emplace(coord));
         }
     }
 
-    LoadedChunkBlockProvider blockProvider(chunks);
+    std::vector<ChunkCoord> coords;
+    coords.reserve(terrain.chunks.size());
+    for (const auto &[coord, chunk] : terrain.chunks)
+    {
+        coords.push_back(coord);
+    }
+
+    {
+        const CpuProfiler::Zone lightZone("LightEngine::initialize");
+        LightEngine lightEngine{};
+        lightEngine.initialize(terrain.chunks, coords);
+    }
+
+    ChunkMapBlockProvider blockProvider(terrain.chunks);
     
     ChunkMesher mesher{};
     
-    Mesh combinedMesh{};
-    combinedMesh.vertices.reserve(static_cast<size_t>(chunkColumnsX) * static_cast<size_t>(chunkColumnsZ) * 512);
-    combinedMesh.indices.reserve(static_cast<size_t>(chunkColumnsX) * static_cast<size_t>(chunkColumnsZ) * 768);
+    terrain.meshes.reserve(terrain.chunks.size());
 
     for (uint32_t columnZ = 0; columnZ < chunkColumnsZ; columnZ++)
     {
         for (uint32_t columnX = 0; columnX < chunkColumnsX; columnX++)
         {
             const ChunkCoord coord = {
-                .x = startChunkX + static_cast<int32_t>(columnX),
-                .z = startChunkZ + static_cast<int32_t>(columnZ),
+                .x = start.x + static_cast<int32_t>(columnX),
+                .z = start.z + static_cast<int32_t>(columnZ),
             };
 
-            const auto chunk = chunks.find(coord);
-            if (chunk == chunks.end())
+            Chunk *chunk = terrain.chunks.find(coord);
+            if (chunk == nullptr)
             {
                 continue;
             }
 
-            const uint32_t lodStep = chunkLodStep(settings, columnX, columnZ);
-            appendChunkMesh(combinedMesh, mesher.mesh(chunk->second, blockProvider, ChunkMeshingOptions{
-                .lodStep = lodStep,
-                .positionOffset = glm::vec3{ 0.0f },
-            }));
+            const CpuProfiler::Zone meshZone("ChunkMesher::mesh");
+            terrain.meshes.push_back(mesher.mesh(*chunk, blockProvider, chunkMeshingOptions(settings, coord)));
+        }
+    }
+
+    return terrain;
+}
+
+void World::markChunkDirty(const ChunkCoord coord)
+{
+    Chunk *chunk = m_chunks.find(coord);
+    if (chunk == nullptr)
+    {
+        return;
+    }
+
+    chunk->markDirty();
+    m_dirtyChunks.insert(coord);
+}
+
+void World::relightBlocks(std::span<const glm::ivec3> changedBlocks)
+{
+    if (changedBlocks.empty())
+    {
+        return;
+    }
+
+    const CpuProfiler::Zone zone("LightEngine::update");
+
+    std::unordered_map<ChunkCoord, Chunk::EditSummary> touchedChunks;
+    m_lightEngine.update(m_chunks, changedBlocks, touchedChunks);
+
+    /* Neighbours light the faces that look into our border cells, so they may have to re-mesh as well */
+    for (const auto &[coord, summary] : touchedChunks)
+    {
+        markChunkDirty(coord);
+        markBorderNeighboursDirty(coord, summary);
+    }
+}
+
+void World::markEditedChunkDirty(const ChunkCoord coord, const Chunk::EditSummary &summary)
+{
+    if (summary.changedBlocks == 0)
+    {
+        return;
+    }
+
+    markChunkDirty(coord);
+    m_editedChunks.insert(coord);
+    markBorderNeighboursDirty(coord, summary);
+
+    /* AO also reads the corner cells of the padded border, so an edit that reaches both an x and a z border shows up diagonally */
+    for (const int32_t dz : { -1, 1 })
+    {
+        for (const int32_t dx : { -1, 1 })
+        {
+            const ChunkCoord diagonal = { .x = coord.x + dx, .z = coord.z + dz };
+            const uint32_t lodStep = chunkLodStep(m_settings, diagonal);
+            const bool reachesX = dx < 0 ? summary.minX < lodStep : summary.maxX >= CHUNK_WIDTH - lodStep;
+            const bool reachesZ = dz < 0 ? summary.minZ < lodStep : summary.maxZ >= CHUNK_DEPTH - lodStep;
+            if (reachesX && reachesZ)
+            {
+                markChunkDirty(diagonal);
+            }
+        }
+    }
+}
+
+void World::markBorderNeighboursDirty(const ChunkCoord coord, const Chunk::EditSummary &summary)
+{
+    /* Neighbours sample our border blocks and light a whole LOD cell deep, to decide which of their faces are visible and how they are lit */
+    const ChunkCoord west = { .x = coord.x - 1, .z = coord.z };
+    const ChunkCoord east = { .x = coord.x + 1, .z = coord.z };
+    const ChunkCoord north = { .x = coord.x, .z = coord.z - 1 };
+    const ChunkCoord south = { .x = coord.x, .z = coord.z + 1 };
+
+    if (summary.minX < chunkLodStep(m_settings, west))
+    {
+        markChunkDirty(west);
+    }
+
+    if (summary.maxX >= CHUNK_WIDTH - chunkLodStep(m_settings, east))
+    {
+        markChunkDirty(east);
+    }
+
+    if (summary.minZ < chunkLodStep(m_settings, north))
+    {
+        markChunkDirty(north);
+    }
+
+    if (summary.maxZ >= CHUNK_DEPTH - chunkLodStep(m_settings, south))
+    {
+        markChunkDirty(south);
+    }
+}
+
+void World::startMeshWorkers(void)
+{
+    if (!m_meshWorkers.empty())
+    {
+        return;
+    }
+
+    const uint32_t workerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    m_meshWorkers.reserve(workerCount);
+
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        m_meshWorkers.emplace_back(&World::meshWorkerLoop, this);
+    }
+}
+
+void World::stopMeshWorkers(void)
+{
+    {
+        std::lock_guard lock(m_jobMutex);
+        m_stopMeshWorkers = true;
+    }
+
+    m_jobCondition.notify_all();
+
+    for (std::thread &worker : m_meshWorkers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
         }
     }
 
-    return combinedMesh;
+    m_meshWorkers.clear();
+}
+
+void World::meshWorkerLoop(void)
+{
+    CpuProfiler::setThreadName("World mesh worker");
+
+    ChunkMesher mesher{};
+
+    while (true)
+    {
+        ChunkCoord coord{};
+        {
+            std::unique_lock lock(m_jobMutex);
+            m_jobCondition.wait(lock, [this]() { return m_stopMeshWorkers || !m_meshJobs.empty(); });
+
+            if (m_stopMeshWorkers)
+            {
+                return;
+            }
+
+            coord = m_meshJobs.front();
+            m_meshJobs.pop_front();
+        }
+
+        try
+        {
+            /* Includes waiting for the chunk lock, which is where edits on the main thread stall the workers */
+            const CpuProfiler::Zone zone("World mesh job");
+            std::shared_lock chunkLock(m_chunkMutex);
+
+            Chunk *chunk = m_chunks.find(coord);
+            if (chunk != nullptr)
+            {
+                Mesh mesh = mesher.mesh(*chunk, ChunkMapBlockProvider(m_chunks), chunkMeshingOptions(m_settings, coord));
+                chunkLock.unlock();
+
+                std::lock_guard meshLock(m_meshMutex);
+                m_readyMeshBytes += mesh.memoryBytes();
+                m_peakMeshBytes = std::max(m_peakMeshBytes, m_readyMeshBytes);
+                m_readyMeshes.push_back(std::move(mesh));
+            }
+        }
+        catch (const std::exception &)
+        {
+        }
+
+        std::lock_guard lock(m_jobMutex);
+        m_meshingChunks.erase(coord);
+    }
 }
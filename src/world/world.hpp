@@ -2,13 +2,22 @@
 
 #include "world/block.hpp"
 #include "world/chunk.hpp"
+#include "world/chunk_map.hpp"
 #include "world/chunk_mesher.hpp"
+#include "world/light_engine.hpp"
+
+#include <glm/glm.hpp>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <span>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 class World
@@ -30,8 +39,57 @@ public:
         bool enableLevelOfDetail = false;
     };
 
-    std::vector<Voxel> vertices{};
-    std::vector<uint32_t> indices{};
+    struct BlockEdit
+    {
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t z = 0;
+        BlockType block = BlockType::Air;
+    };
+
+    struct Ray
+    {
+        glm::vec3 origin{ 0.0f };
+        glm::vec3 direction{ 0.0f, 0.0f, 1.0f };
+        float maxDistance = 0.0f;
+    };
+
+    struct RaycastHit
+    {
+        glm::ivec3 block{ 0 };
+        glm::ivec3 normal{ 0 }; /* Face that was entered, zero if the ray started inside the block */
+        float distance = 0.0f;
+        BlockType type = BlockType::Air;
+    };
+
+    struct Aabb
+    {
+        glm::vec3 min{ 0.0f };
+        glm::vec3 max{ 0.0f };
+    };
+
+    struct SweepResult
+    {
+        glm::vec3 motion{ 0.0f };      /* How far the box could actually move */
+        glm::bvec3 collided{ false };  /* Which axes were stopped by a block */
+    };
+
+    /* What the world holds right now, and the most it has held at once */
+    struct MemoryStats
+    {
+        size_t chunkCount = 0;
+        size_t chunkBytes = 0;     /* Blocks, light and heightmaps of the loaded chunks and the pooled spares */
+        size_t peakChunkBytes = 0;
+        size_t meshBytes = 0;      /* Quads of the meshes that are built but not consumed yet */
+        size_t peakMeshBytes = 0;
+        size_t evictedChunkCount = 0;
+    };
+
+    struct MemoryBudget
+    {
+        size_t chunkBytes = 0;       /* Cap on the loaded chunks, 0 for none. The few pooled spares come on top */
+        uint32_t residentRadius = 8; /* In chunks around the focus: never evicted, and brought back once evicted */
+    };
 
     World() = default;
     ~World();
@@ -43,15 +101,101 @@ public:
 
     void generateTerrain(const uint32_t width, const uint32_t depth);
     void requestChunkGeneration(const GenerationSettings &settings);
-    [[nodiscard]] bool consumeGeneratedMesh(Mesh &mesh);
+    [[nodiscard]] bool consumeChunkMeshes(std::vector<Mesh> &meshes);
     [[nodiscard]] bool isGenerating(void) const;
+    [[nodiscard]] MemoryStats memoryStats(void) const;
+
+    [[nodiscard]] BlockType getBlock(const int32_t worldX, const int32_t y, const int32_t worldZ) const;
+
+    /* Returns false if the block lies outside of the loaded chunks. Light is updated right away, the
+       re-meshing of every chunk the edit (or its light) reaches is picked up by the next flushDirtyChunks() */
+    bool setBlock(const int32_t worldX, const int32_t y, const int32_t worldZ, const BlockType block);
+
+    /* Groups the edits by chunk and applies each group in a single pass, later edits to the same block win.
+       Returns the number of blocks that changed; edits outside of the loaded chunks are dropped */
+    uint32_t applyEdits(std::span<const BlockEdit> edits);
+
+    /* Sets every block in the inclusive region [min, max] */
+    uint32_t fillRegion(const int32_t minX, const int32_t minY, const int32_t minZ, const int32_t maxX, const int32_t maxY, const int32_t maxZ, const BlockType block);
+
+    /* Amanatides-Woo traversal; unloaded chunks, empty sections and the air above the heightmap are each crossed in a single step */
+    [[nodiscard]] std::optional<RaycastHit> raycast(const glm::vec3 &origin, const glm::vec3 &direction, const float maxDistance) const;
+
+    /* Same as above, but takes the chunk lock once for the whole batch */
+    void raycast(std::span<const Ray> rays, std::span<std::optional<RaycastHit>> hits) const;
+
+    /* Moves the box one axis at a time (Y, X, then Z) and stops each axis at the first solid block in its path.
+       Only the voxels the swept box passes through are read; blocks the box already overlaps never block it */
+    [[nodiscard]] SweepResult sweepAabb(const Aabb &box, const glm::vec3 &motion) const;
+
+    /* Same as above, but takes the chunk lock once for the whole batch */
+    void sweepAabb(std::span<const Aabb> boxes, std::span<const glm::vec3> motions, std::span<SweepResult> results) const;
+
+    [[nodiscard]] bool intersectsSolid(const Aabb &box) const;
+
+    /* Hands every dirty chunk that isn't already being meshed over to the mesh workers, call once per frame */
+    void flushDirtyChunks(void);
+
+    void setMemoryBudget(const MemoryBudget &budget);
+
+    /* Over budget, drops the block data of the chunks farthest from the focus, outside of the resident radius, until it fits again.
+       Their meshes stay where they are. Evicted chunks that are back within the resident radius are regenerated from the seed, a
+       few per call. Edited chunks are never evicted, the generator couldn't bring the edits back, and neither are chunks with a
+       mesh job still to run. Takes the exclusive lock only when there is something to do. Call once per frame */
+    void updateResidency(const glm::vec3 &focus);
+
+    /* Meshes the chunks again, e.g. after the renderer dropped their geometry. Evicted ones are regenerated first */
+    void requestMeshes(std::span<const ChunkCoord> coords);
 
 private:
+    static constexpr uint32_t MAX_RELOADS_PER_UPDATE = 4;
+
+    struct GeneratedTerrain
+    {
+        ChunkMap chunks{};
+        std::vector<Mesh> meshes{};
+    };
+
     void joinGenerationThread(void);
-    static Mesh generateChunkedTerrain(const GenerationSettings &settings);
+    void publishTerrain(const GenerationSettings &settings, GeneratedTerrain terrain);
+    static GeneratedTerrain generateChunkedTerrain(const GenerationSettings &settings);
+
+    void markChunkDirty(const ChunkCoord coord);
+    void reloadChunk(const ChunkCoord coord);
+
+    /* Edited, or waiting for or in the middle of a mesh job - evicting those would lose the edits or drop the job. Needs both locks */
+    [[nodiscard]] bool pinned(const ChunkCoord coord) const;
+    void relightBlocks(std::span<const glm::ivec3> changedBlocks);
+    void markEditedChunkDirty(const ChunkCoord coord, const Chunk::EditSummary &summary);
+    void markBorderNeighboursDirty(const ChunkCoord coord, const Chunk::EditSummary &summary);
+    void startMeshWorkers(void);
+    void stopMeshWorkers(void);
+    void meshWorkerLoop(void);
 
     std::thread m_generationThread;
-    mutable std::mutex m_meshMutex;
-    std::optional<Mesh> m_pendingMesh;
     std::atomic_bool m_generating{ false };
+
+    /* Guards m_chunks, m_settings, m_dirtyChunks, m_lightEngine and the residency state - mesh workers only ever take it shared */
+    mutable std::shared_mutex m_chunkMutex;
+    ChunkMap m_chunks{};
+    size_t m_peakChunkBytes = 0;
+    GenerationSettings m_settings{};
+    std::unordered_set<ChunkCoord> m_dirtyChunks{};
+    LightEngine m_lightEngine{};
+    MemoryBudget m_memoryBudget{};
+    std::unordered_set<ChunkCoord> m_evictedChunks{};
+    std::unordered_set<ChunkCoord> m_editedChunks{}; /* Pinned, they differ from what the generator would make */
+
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobCondition;
+    std::deque<ChunkCoord> m_meshJobs{};
+    std::unordered_set<ChunkCoord> m_meshingChunks{};
+    std::vector<std::thread> m_meshWorkers{};
+    bool m_stopMeshWorkers = false;
+
+    /* Guards m_readyMeshes and the byte counts of the meshes in it */
+    mutable std::mutex m_meshMutex;
+    std::vector<Mesh> m_readyMeshes{};
+    size_t m_readyMeshBytes = 0;
+    size_t m_peakMeshBytes = 0;
 };
@@ -0,0 +1,501 @@
+#include "world/chunk_map_block_provider.hpp"
+#include "world/chunk_mesher.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Checks ChunkMesher::mesh() against a brute-force reference that emits one face per exposed face of every LOD cell. The greedy
+   quads are broken back into cell faces, and the two face sets have to match exactly - same faces, same block, light and AO, and
+   no face covered twice. Inputs are random and hand-picked chunks at every LOD step, with and without neighbours around them */
+
+namespace
+{
+    constexpr uint32_t RANDOM_CASES = 48;
+    constexpr uint32_t MAX_REPORTED_FAILURES = 16;
+
+    /* 3 and 8 aren't valid steps, the mesher has to round them down */
+    constexpr std::array<uint32_t, 5> LOD_STEPS = { 1, 2, 3, 4, 8 };
+
+    constexpr ChunkCoord CENTER{ .x = 3, .z = -2 };
+
+    struct FaceAttributes
+    {
+        BlockType block = BlockType::Air;
+        uint8_t light = 0;
+        uint8_t ambientOcclusion = 0;
+
+        [[nodiscard]] bool operator==(const FaceAttributes &other) const = default;
+    };
+
+    /* Every possible cell face of a chunk at one LOD step, indexed by direction and cell */
+    class FaceGrid
+    {
+    public:
+        explicit FaceGrid(const uint32_t step)
+            : m_dims{ Chunk::WIDTH / step, Chunk::HEIGHT / step, Chunk::DEPTH / step }
+        {
+            m_faces.resize(static_cast<size_t>(ChunkMesh::FACE_DIRECTION_COUNT) * m_dims[0] * m_dims[1] * m_dims[2]);
+        }
+
+        [[nodiscard]] const std::array<uint32_t, 3> &dims(void) const { return m_dims; }
+
+        [[nodiscard]] std::optional<FaceAttributes> &at(const uint32_t direction, const std::array<uint32_t, 3> &cell)
+        {
+            return m_faces.at(((static_cast<size_t>(direction) * m_dims[1] + cell[1]) * m_dims[2] + cell[2]) * m_dims[0] + cell[0]);
+        }
+
+    private:
+        std::array<uint32_t, 3> m_dims{};
+        std::vector<std::optional<FaceAttributes>> m_faces{};
+    };
+
+    [[nodiscard]] uint32_t expectedLodStep(const uint32_t lodStep)
+    {
+        return lodStep >= 4 ? 4 : lodStep >= 2 ? 2 : 1;
+    }
+
+    /* The slow way round: every block of every cell is looked up on its own, through the chunk if it's inside, otherwise the provider */
+    class ReferenceMesher
+    {
+    public:
+        ReferenceMesher(const Chunk &chunk, const ChunkBlockProvider &provider, const uint32_t step)
+            : m_chunk(chunk), m_provider(provider), m_step(static_cast<int32_t>(step))
+        {
+        }
+
+        [[nodiscard]] FaceGrid faces(void) const
+        {
+            FaceGrid grid(static_cast<uint32_t>(m_step));
+            const std::array<uint32_t, 3> dims = grid.dims();
+
+            for (uint32_t direction = 0; direction < ChunkMesh::FACE_DIRECTION_COUNT; direction++)
+            {
+                const uint32_t axis = direction / 2;
+                const int32_t sign = direction % 2 == 0 ? 1 : -1;
+
+                for (uint32_t y = 0; y < dims[1]; y++)
+                {
+                    for (uint32_t z = 0; z < dims[2]; z++)
+                    {
+                        for (uint32_t x = 0; x < dims[0]; x++)
+                        {
+                            const std::array<int32_t, 3> cell = { static_cast<int32_t>(x), static_cast<int32_t>(y), static_cast<int32_t>(z) };
+                            const BlockType block = cellBlock(cell);
+                            if (block == BlockType::Air)
+                            {
+                                continue;
+                            }
+
+                            std::array<int32_t, 3> front = cell;
+                            front[axis] += sign;
+                            if (cellBlock(front) != BlockType::Air)
+                            {
+                                continue;
+                            }
+
+                            grid.at(direction, { x, y, z }) = FaceAttributes{
+                                .block = block,
+                                .light = cellLight(front),
+                                .ambientOcclusion = ambientOcclusion(front, axis),
+                            };
+                        }
+                    }
+                }
+            }
+
+            return grid;
+        }
+
+    private:
+        [[nodiscard]] bool insideChunk(const int32_t x, const int32_t y, const int32_t z) const
+        {
+            return x >= 0 && y >= 0 && z >= 0 && x < static_cast<int32_t>(Chunk::WIDTH) && y < static_cast<int32_t>(Chunk::HEIGHT) && z < static_cast<int32_t>(Chunk::DEPTH);
+        }
+
+        void forEachBlock(const std::array<int32_t, 3> &cell, const std::function<void(int32_t, int32_t, int32_t)> &visit) const
+        {
+            for (int32_t dy = 0; dy < m_step; dy++)
+            {
+                for (int32_t dz = 0; dz < m_step; dz++)
+                {
+                    for (int32_t dx = 0; dx < m_step; dx++)
+                    {
+                        visit(cell[0] * m_step + dx, cell[1] * m_step + dy, cell[2] * m_step + dz);
+                    }
+                }
+            }
+        }
+
+        /* Air only if every block is air, otherwise the most common solid block - ties go to the lower BlockType */
+        [[nodiscard]] BlockType cellBlock(const std::array<int32_t, 3> &cell) const
+        {
+            std::array<uint32_t, BLOCK_TYPE_COUNT> counts{};
+            forEachBlock(cell, [&](const int32_t x, const int32_t y, const int32_t z)
+            {
+                const BlockType block = insideChunk(x, y, z)
+                    ? m_chunk.get(static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint32_t>(z))
+                    : m_provider.blockAt(m_chunk.minBlockX() + x, y, m_chunk.minBlockZ() + z);
+                counts.at(static_cast<size_t>(block))++;
+            });
+
+            BlockType best = BlockType::Air;
+            for (uint8_t type = 1; type < BLOCK_TYPE_COUNT; type++)
+            {
+                if (counts.at(type) > 0 && (best == BlockType::Air || counts.at(type) > counts.at(static_cast<size_t>(best))))
+                {
+                    best = static_cast<BlockType>(type);
+                }
+            }
+
+            return best;
+        }
+
+        /* Brightest sky and block light anywhere in the cell, each on its own */
+        [[nodiscard]] uint8_t cellLight(const std::array<int32_t, 3> &cell) const
+        {
+            uint8_t sky = 0;
+            uint8_t block = 0;
+            forEachBlock(cell, [&](const int32_t x, const int32_t y, const int32_t z)
+            {
+                const uint8_t light = insideChunk(x, y, z)
+                    ? m_chunk.packedLight(Chunk::index(static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint32_t>(z)))
+                    : m_provider.lightAt(m_chunk.minBlockX() + x, y, m_chunk.minBlockZ() + z);
+                sky = std::max(sky, static_cast<uint8_t>(light >> 4u));
+                block = std::max(block, static_cast<uint8_t>(light & 0x0Fu));
+            });
+
+            return static_cast<uint8_t>(sky << 4u | block);
+        }
+
+        /* Corners -u-v, +u-v, +u+v, -u+v at 2 bits each: 3 minus the solid cells around the corner, 0 when both sides are solid */
+        [[nodiscard]] uint8_t ambientOcclusion(const std::array<int32_t, 3> &front, const uint32_t axis) const
+        {
+            const uint32_t uAxis = (axis + 1) % 3;
+            const uint32_t vAxis = (axis + 2) % 3;
+            constexpr std::array<std::array<int32_t, 2>, 4> CORNERS = {{ { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } }};
+
+            auto solid = [&](const int32_t du, const int32_t dv)
+            {
+                std::array<int32_t, 3> cell = front;
+                cell[uAxis] += du;
+                cell[vAxis] += dv;
+                return cellBlock(cell) != BlockType::Air ? 1 : 0;
+            };
+
+            uint8_t signature = 0;
+            for (uint32_t corner = 0; corner < CORNERS.size(); corner++)
+            {
+                const int32_t side1 = solid(CORNERS[corner][0], 0);
+                const int32_t side2 = solid(0, CORNERS[corner][1]);
+                const int32_t diagonal = solid(CORNERS[corner][0], CORNERS[corner][1]);
+                const int32_t value = side1 != 0 && side2 != 0 ? 0 : 3 - side1 - side2 - diagonal;
+                signature = static_cast<uint8_t>(signature | value << (corner * 2));
+            }
+
+            return signature;
+        }
+
+        const Chunk &m_chunk;
+        const ChunkBlockProvider &m_provider;
+        int32_t m_step = 1;
+    };
+
+    /* Returns what went wrong, or nothing if the mesh covers exactly the reference faces */
+    [[nodiscard]] std::optional<std::string> compare(const ChunkMesh &mesh, FaceGrid reference, const uint32_t requestedStep)
+    {
+        const uint32_t step = expectedLodStep(requestedStep);
+        if (mesh.lodStep != step)
+        {
+            return std::format("lodStep {} was meshed at {} instead of {}", requestedStep, mesh.lodStep, step);
+        }
+
+        if (mesh.directionOffsets.front() != 0 || mesh.directionOffsets.back() != mesh.quadCount())
+        {
+            return std::string("direction offsets don't span the quads");
+        }
+
+        const std::array<uint32_t, 3> dims = reference.dims();
+
+        for (uint32_t direction = 0; direction < ChunkMesh::FACE_DIRECTION_COUNT; direction++)
+        {
+            if (mesh.directionOffsets.at(direction) > mesh.directionOffsets.at(direction + 1))
+            {
+                return std::format("direction {} has a negative quad range", direction);
+            }
+
+            for (uint32_t i = mesh.directionOffsets.at(direction); i < mesh.directionOffsets.at(direction + 1); i++)
+            {
+                const ChunkQuad &quad = mesh.quads.at(i);
+                if (quad.faceDirection() != direction)
+                {
+                    return std::format("quad {} faces direction {} but lies in the range of direction {}", i, quad.faceDirection(), direction);
+                }
+
+                const uint32_t axis = quad.axis();
+                const uint32_t uAxis = (axis + 1) % 3;
+                const uint32_t vAxis = (axis + 2) % 3;
+                const glm::uvec3 origin = quad.origin();
+
+                if (origin.x % step != 0 || origin.y % step != 0 || origin.z % step != 0 || quad.width() % step != 0 || quad.height() % step != 0)
+                {
+                    return std::format("quad {} isn't aligned to the LOD grid", i);
+                }
+
+                /* Positive faces sit on the far side of their cell */
+                const uint32_t plane = origin[static_cast<int>(axis)] / step;
+                if (quad.isPositive() ? plane == 0 || plane > dims[axis] : plane >= dims[axis])
+                {
+                    return std::format("quad {} belongs to a cell outside of the chunk (plane {} on axis {})", i, plane, axis);
+                }
+
+                std::array<uint32_t, 3> cell = { origin.x / step, origin.y / step, origin.z / step };
+                cell[axis] = quad.isPositive() ? plane - 1 : plane;
+
+                const uint32_t uCells = quad.width() / step;
+                const uint32_t vCells = quad.height() / step;
+                if (cell[uAxis] + uCells > dims[uAxis] || cell[vAxis] + vCells > dims[vAxis])
+                {
+                    return std::format("quad {} reaches past the chunk", i);
+                }
+
+                const FaceAttributes attributes{ .block = quad.block(), .light = quad.light(), .ambientOcclusion = quad.ambientOcclusion() };
+
+                for (uint32_t v = 0; v < vCells; v++)
+                {
+                    for (uint32_t u = 0; u < uCells; u++)
+                    {
+                        std::array<uint32_t, 3> covered = cell;
+                        covered[uAxis] += u;
+                        covered[vAxis] += v;
+
+                        std::optional<FaceAttributes> &expected = reference.at(direction, covered);
+                        if (!expected.has_value())
+                        {
+                            return std::format("quad {} covers a face the reference doesn't have (or that an earlier quad covered) at cell ({}, {}, {}) direction {}",
+                                i, covered[0], covered[1], covered[2], direction);
+                        }
+
+                        if (!(*expected == attributes))
+                        {
+                            return std::format("quad {} disagrees at cell ({}, {}, {}) direction {}: block {}/{} light {}/{} AO {}/{} (mesher/reference)",
+                                i, covered[0], covered[1], covered[2], direction,
+                                static_cast<uint32_t>(attributes.block), static_cast<uint32_t>(expected->block),
+                                attributes.light, expected->light, attributes.ambientOcclusion, expected->ambientOcclusion);
+                        }
+
+                        expected.reset();
+                    }
+                }
+            }
+        }
+
+        for (uint32_t direction = 0; direction < ChunkMesh::FACE_DIRECTION_COUNT; direction++)
+        {
+            for (uint32_t y = 0; y < dims[1]; y++)
+            {
+                for (uint32_t z = 0; z < dims[2]; z++)
+                {
+                    for (uint32_t x = 0; x < dims[0]; x++)
+                    {
+                        if (reference.at(direction, { x, y, z }).has_value())
+                        {
+                            return std::format("no quad covers the face at cell ({}, {}, {}) direction {}", x, y, z, direction);
+                        }
+                    }
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    using BlockPattern = std::function<BlockType(uint32_t x, uint32_t y, uint32_t z)>;
+
+    [[nodiscard]] Chunk makeChunk(const ChunkCoord coord, const BlockPattern &pattern, std::mt19937 &random, const bool randomLight)
+    {
+        Chunk chunk(coord);
+        std::uniform_int_distribution<uint32_t> level(0, Chunk::MAX_LIGHT);
+
+        for (uint32_t y = 0; y < Chunk::HEIGHT; y++)
+        {
+            for (uint32_t z = 0; z < Chunk::DEPTH; z++)
+            {
+                for (uint32_t x = 0; x < Chunk::WIDTH; x++)
+                {
+                    const BlockType block = pattern(x, y, z);
+                    if (block != BlockType::Air)
+                    {
+                        chunk.set(x, y, z, block);
+                    }
+
+                    if (randomLight)
+                    {
+                        const size_t index = Chunk::index(x, y, z);
+                        chunk.setSkyLight(index, static_cast<uint8_t>(level(random)));
+                        chunk.setBlockLight(index, static_cast<uint8_t>(level(random)));
+                    }
+                }
+            }
+        }
+
+        return chunk;
+    }
+
+    [[nodiscard]] BlockPattern randomPattern(std::mt19937 &random, const float density, const uint32_t blockTypes)
+    {
+        /* Drawn up front so the pattern gives the same answer however often a block is asked for */
+        auto blocks = std::make_shared<std::vector<BlockType>>(Chunk::BLOCK_COUNT, BlockType::Air);
+        std::bernoulli_distribution solid(density);
+        std::uniform_int_distribution<uint32_t> type(1, blockTypes);
+        for (BlockType &block : *blocks)
+        {
+            block = solid(random) ? static_cast<BlockType>(type(random)) : BlockType::Air;
+        }
+
+        return [blocks](const uint32_t x, const uint32_t y, const uint32_t z) { return (*blocks)[Chunk::index(x, y, z)]; };
+    }
+
+    struct Case
+    {
+        std::string name{};
+        BlockPattern center{};
+        BlockPattern neighbours{}; /* Empty for no loaded neighbours at all */
+        bool randomLight = false;
+    };
+
+    [[nodiscard]] std::vector<Case> adversarialCases(void)
+    {
+        const BlockPattern empty = [](uint32_t, uint32_t, uint32_t) { return BlockType::Air; };
+        const BlockPattern full = [](uint32_t, uint32_t, uint32_t) { return BlockType::Stone; };
+
+        std::vector<Case> cases = {
+            { .name = "empty", .center = empty },
+            { .name = "full, no neighbours", .center = full },
+            { .name = "full, full neighbours", .center = full, .neighbours = full },
+            { .name = "full, empty neighbours", .center = full, .neighbours = empty },
+            { .name = "3D checkerboard", .center = [](uint32_t x, uint32_t y, uint32_t z) { return (x + y + z) % 2 == 0 ? BlockType::Dirt : BlockType::Air; } },
+            { .name = "checkerboard of block types", .center = [](uint32_t x, uint32_t y, uint32_t z) { return (x + y + z) % 2 == 0 ? BlockType::Stone : BlockType::Sand; }, .neighbours = full },
+            { .name = "alternating columns", .center = [](uint32_t x, uint32_t, uint32_t z) { return (x + z) % 2 == 0 ? BlockType::Grass : BlockType::Air; } },
+            { .name = "stripes break every merge", .center = [](uint32_t x, uint32_t y, uint32_t) { return y < 20 ? static_cast<BlockType>(1 + x % (BLOCK_TYPE_COUNT - 1)) : BlockType::Air; } },
+            { .name = "bottom and top layer", .center = [](uint32_t, uint32_t y, uint32_t) { return y == 0 || y == Chunk::HEIGHT - 1 ? BlockType::Stone : BlockType::Air; } },
+            { .name = "single blocks in the corners", .center = [](uint32_t x, uint32_t y, uint32_t z) {
+                const bool edgeX = x == 0 || x == Chunk::WIDTH - 1;
+                const bool edgeY = y == 0 || y == Chunk::HEIGHT - 1;
+                const bool edgeZ = z == 0 || z == Chunk::DEPTH - 1;
+                return edgeX && edgeY && edgeZ ? BlockType::Lamp : BlockType::Air;
+            } },
+            { .name = "walls facing the neighbours' walls", .center = [](uint32_t x, uint32_t, uint32_t z) {
+                return x == 0 || z == Chunk::DEPTH - 1 ? BlockType::Sand : BlockType::Air;
+            }, .neighbours = [](uint32_t x, uint32_t, uint32_t z) {
+                return x == Chunk::WIDTH - 1 || z == 0 ? BlockType::Stone : BlockType::Air;
+            } },
+            { .name = "one block per LOD cell ties", .center = [](uint32_t x, uint32_t y, uint32_t z) {
+                /* Two different blocks in every 2x2x2 cell, so the dominant block is decided by a tie */
+                const uint32_t corner = x % 2 + (y % 2) * 2 + (z % 2) * 4;
+                return corner == 0 ? BlockType::Stone : corner == 7 ? BlockType::Grass : BlockType::Air;
+            }, .randomLight = true },
+            { .name = "terrain with random light", .center = [](uint32_t x, uint32_t y, uint32_t z) {
+                const uint32_t height = 20 + (x * 7 + z * 13) % 17;
+                return y < height ? (y + 1 == height ? BlockType::Grass : BlockType::Dirt) : BlockType::Air;
+            }, .neighbours = [](uint32_t x, uint32_t y, uint32_t z) {
+                return y < 18 + (x * 5 + z * 3) % 23 ? BlockType::Stone : BlockType::Air;
+            }, .randomLight = true },
+        };
+
+        return cases;
+    }
+
+    /* Counts every LOD step at which the mesher and the reference disagree, and prints why */
+    void runCase(const Case &testCase, std::mt19937 &random, uint32_t &failures)
+    {
+        ChunkMap chunks;
+        chunks.insert(makeChunk(CENTER, testCase.center, random, testCase.randomLight));
+
+        if (testCase.neighbours)
+        {
+            for (int32_t dz = -1; dz <= 1; dz++)
+            {
+                for (int32_t dx = -1; dx <= 1; dx++)
+                {
+                    const ChunkCoord coord{ .x = CENTER.x + dx, .z = CENTER.z + dz };
+                    if (dx != 0 || dz != 0)
+                    {
+                        chunks.insert(makeChunk(coord, testCase.neighbours, random, testCase.randomLight));
+                    }
+                }
+            }
+        }
+
+        const ChunkMapBlockProvider provider(chunks);
+        const Chunk &chunk = chunks.at(CENTER);
+        const ChunkMesher mesher{};
+
+        for (const uint32_t lodStep : LOD_STEPS)
+        {
+            const ChunkMesh mesh = mesher.mesh(chunk, provider, ChunkMeshingOptions{ .lodStep = lodStep });
+            const ReferenceMesher reference(chunk, provider, expectedLodStep(lodStep));
+
+            const std::optional<std::string> error = compare(mesh, reference.faces(), lodStep);
+            if (error.has_value())
+            {
+                if (++failures <= MAX_REPORTED_FAILURES)
+                {
+                    std::println("FAIL {} (lodStep {}): {}", testCase.name, lodStep, *error);
+                }
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    try
+    {
+        std::mt19937 random(20240611);
+        uint32_t failures = 0;
+        uint32_t caseCount = 0;
+
+        for (const Case &testCase : adversarialCases())
+        {
+            runCase(testCase, random, failures);
+            caseCount++;
+        }
+
+        constexpr std::array<float, 4> DENSITIES = { 0.05f, 0.3f, 0.6f, 0.95f };
+        for (uint32_t i = 0; i < RANDOM_CASES; i++)
+        {
+            const float density = DENSITIES.at(i % DENSITIES.size());
+            const uint32_t blockTypes = i % 3 == 0 ? 1 : BLOCK_TYPE_COUNT - 1;
+            const bool withNeighbours = i % 2 == 0;
+
+            const Case testCase{
+                .name = std::format("random #{} (density {}, {} block types{})", i, density, blockTypes, withNeighbours ? ", neighbours" : ""),
+                .center = randomPattern(random, density, blockTypes),
+                .neighbours = withNeighbours ? randomPattern(random, density, blockTypes) : BlockPattern{},
+                .randomLight = i % 4 < 2,
+            };
+
+            runCase(testCase, random, failures);
+            caseCount++;
+        }
+
+        std::println("{} cases at {} LOD steps each, {} failed", caseCount, LOD_STEPS.size(), failures);
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (const std::exception &e)
+    {
+        std::println("{}", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,138 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "renderer/block_textures.hpp"
+#include "renderer/texture_container.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Bakes the block textures into the container the renderer maps at startup: texture_baker [output] */
+
+namespace
+{
+    [[nodiscard]] float srgbToLinear(const uint8_t value)
+    {
+        const float c = static_cast<float>(value) / 255.0f;
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    [[nodiscard]] uint8_t linearToSrgb(const float value)
+    {
+        const float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::clamp(std::lround(c * 255.0f), 0l, 255l));
+    }
+
+    /* 2x2 box filter of every layer, colour is averaged in linear space and alpha as it is */
+    [[nodiscard]] TextureContainerLevelData downsample(const TextureContainerLevelData &source, const uint32_t width, const uint32_t height, const uint32_t layerCount)
+    {
+        const uint32_t nextWidth = std::max(width / 2, 1u);
+        const uint32_t nextHeight = std::max(height / 2, 1u);
+        TextureContainerLevelData level(static_cast<size_t>(nextWidth) * nextHeight * 4 * layerCount);
+
+        for (uint32_t layer = 0; layer < layerCount; layer++)
+        {
+            const uint8_t *sourceLayer = source.data() + static_cast<size_t>(width) * height * 4 * layer;
+            uint8_t *levelLayer = level.data() + static_cast<size_t>(nextWidth) * nextHeight * 4 * layer;
+
+            for (uint32_t y = 0; y < nextHeight; y++)
+            {
+                for (uint32_t x = 0; x < nextWidth; x++)
+                {
+                    std::array<float, 4> sum{};
+                    for (uint32_t dy = 0; dy < 2; dy++)
+                    {
+                        for (uint32_t dx = 0; dx < 2; dx++)
+                        {
+                            const uint32_t sampleX = std::min(x * 2 + dx, width - 1);
+                            const uint32_t sampleY = std::min(y * 2 + dy, height - 1);
+                            const uint8_t *texel = sourceLayer + (static_cast<size_t>(sampleY) * width + sampleX) * 4;
+
+                            sum[0] += srgbToLinear(texel[0]);
+                            sum[1] += srgbToLinear(texel[1]);
+                            sum[2] += srgbToLinear(texel[2]);
+                            sum[3] += static_cast<float>(texel[3]);
+                        }
+                    }
+
+                    uint8_t *texel = levelLayer + (static_cast<size_t>(y) * nextWidth + x) * 4;
+                    texel[0] = linearToSrgb(sum[0] / 4.0f);
+                    texel[1] = linearToSrgb(sum[1] / 4.0f);
+                    texel[2] = linearToSrgb(sum[2] / 4.0f);
+                    texel[3] = static_cast<uint8_t>(std::lround(sum[3] / 4.0f));
+                }
+            }
+        }
+
+        return level;
+    }
+
+    void bake(const std::string &output)
+    {
+        TextureContainerLevelData baseLevel{};
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        for (const char *filename : BLOCK_TEXTURE_FILES)
+        {
+            int texWidth = 0;
+            int texHeight = 0;
+            int texChannels = 0;
+            stbi_uc *pixels = stbi_load(filename, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (!pixels)
+            {
+                throw std::runtime_error(std::string("stbi_load() failed for ") + filename + "!");
+            }
+
+            if (baseLevel.empty())
+            {
+                width = static_cast<uint32_t>(texWidth);
+                height = static_cast<uint32_t>(texHeight);
+            }
+            else if (static_cast<uint32_t>(texWidth) != width || static_cast<uint32_t>(texHeight) != height)
+            {
+                stbi_image_free(pixels);
+                throw std::runtime_error("block textures must all be the same size!");
+            }
+
+            baseLevel.insert(baseLevel.end(), pixels, pixels + static_cast<size_t>(texWidth) * static_cast<size_t>(texHeight) * 4);
+            stbi_image_free(pixels);
+        }
+
+        const uint32_t layerCount = static_cast<uint32_t>(BLOCK_TEXTURE_FILES.size());
+        const uint32_t mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+        std::vector<TextureContainerLevelData> levels{};
+        levels.reserve(mipLevels);
+        levels.push_back(std::move(baseLevel));
+
+        for (uint32_t level = 1; level < mipLevels; level++)
+        {
+            levels.push_back(downsample(levels.back(), std::max(width >> (level - 1), 1u), std::max(height >> (level - 1), 1u), layerCount));
+        }
+
+        writeTextureContainer(output, width, height, layerCount, levels);
+        std::println("baked {} layers of {}x{} with {} mip levels into {}", layerCount, width, height, mipLevels, output);
+    }
+}
+
+int main(int argc, char **argv)
+{
+	try {
+		bake(argc > 1 ? argv[1] : BAKED_BLOCK_TEXTURES_FILE);
+	}
+	catch (const std::exception &e)
+	{
+		std::println("{}", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,180 @@
+#include "world/chunk_generator.hpp"
+#include "world/chunk_map_block_provider.hpp"
+#include "world/chunk_mesher.hpp"
+#include "world/light_engine.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/* Times terrain generation, lighting, meshing at every LOD step and the expansion of quads into vertices over fixed seeds and
+   grid sizes: world_benchmark [repetitions]. Every measurement is printed as one JSON object per line, best and median time
+   of the repetitions, with the rates worked out from the best one */
+
+namespace
+{
+    constexpr std::array<int32_t, 2> SEEDS = { 1337, 12081973 };
+    constexpr std::array<uint32_t, 3> GRID_SIZES = { 4, 8, 16 };
+    constexpr std::array<uint32_t, 3> LOD_STEPS = { 1, 2, 4 };
+    constexpr uint32_t DEFAULT_REPETITIONS = 5;
+
+    struct Timing
+    {
+        double bestSeconds = 0.0;
+        double medianSeconds = 0.0;
+    };
+
+    template <typename Function>
+    [[nodiscard]] Timing measure(const uint32_t repetitions, Function &&function)
+    {
+        std::vector<double> seconds;
+        seconds.reserve(repetitions);
+
+        for (uint32_t repetition = 0; repetition < repetitions; repetition++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        std::sort(seconds.begin(), seconds.end());
+        return Timing{ .bestSeconds = seconds.front(), .medianSeconds = seconds.at(seconds.size() / 2) };
+    }
+
+    [[nodiscard]] std::vector<ChunkCoord> gridCoords(const uint32_t gridSize)
+    {
+        std::vector<ChunkCoord> coords;
+        coords.reserve(static_cast<size_t>(gridSize) * gridSize);
+
+        const int32_t start = -static_cast<int32_t>(gridSize / 2);
+        for (uint32_t z = 0; z < gridSize; z++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                coords.push_back(ChunkCoord{ .x = start + static_cast<int32_t>(x), .z = start + static_cast<int32_t>(z) });
+            }
+        }
+
+        return coords;
+    }
+
+    /* Fields every line has in common, the stage-specific ones are appended */
+    void printResult(const char *stage, const int32_t seed, const uint32_t gridSize, const uint32_t lodStep, const size_t chunkCount, const Timing &timing, const std::string &extra)
+    {
+        const double blocks = static_cast<double>(chunkCount) * Chunk::BLOCK_COUNT;
+        std::println(
+            "{{\"stage\":\"{}\",\"seed\":{},\"grid\":{},\"lodStep\":{},\"chunks\":{},\"bestSeconds\":{:.6f},\"medianSeconds\":{:.6f},\"chunksPerSecond\":{:.1f},\"nsPerBlock\":{:.3f}{}}}",
+            stage, seed, gridSize, lodStep, chunkCount, timing.bestSeconds, timing.medianSeconds,
+            static_cast<double>(chunkCount) / timing.bestSeconds, timing.bestSeconds * 1.0e9 / blocks, extra);
+    }
+
+    void benchmarkGrid(const int32_t seed, const uint32_t gridSize, const uint32_t repetitions)
+    {
+        const std::vector<ChunkCoord> coords = gridCoords(gridSize);
+        const ChunkGenerator generator(seed);
+
+        /* Generated in place like World does. Clearing hands every chunk back to the pool, so all but the first repetition
+           measure the recycled storage of steady-state streaming */
+        ChunkMap chunks;
+        chunks.setMaxSpares(coords.size());
+        const Timing generation = measure(repetitions, [&]()
+        {
+            chunks.clear();
+            chunks.reserve(coords.size());
+            for (const ChunkCoord coord : coords)
+            {
+                generator.generate(chunks.emplace(coord));
+            }
+        });
+        printResult("generate", seed, gridSize, 1, coords.size(), generation, "");
+
+        LightEngine lightEngine{};
+        const Timing lighting = measure(repetitions, [&]()
+        {
+            lightEngine.initialize(chunks, coords);
+        });
+        printResult("light", seed, gridSize, 1, coords.size(), lighting, "");
+
+        const ChunkMapBlockProvider blockProvider(chunks);
+        const ChunkMesher mesher{};
+
+        for (const uint32_t lodStep : LOD_STEPS)
+        {
+            std::vector<ChunkMesh> meshes;
+            const Timing meshing = measure(repetitions, [&]()
+            {
+                meshes.clear();
+                meshes.reserve(coords.size());
+                for (const ChunkCoord coord : coords)
+                {
+                    meshes.push_back(mesher.mesh(chunks.at(coord), blockProvider, ChunkMeshingOptions{ .lodStep = lodStep }));
+                }
+            });
+
+            size_t quadCount = 0;
+            for (const ChunkMesh &mesh : meshes)
+            {
+                quadCount += mesh.quads.size();
+            }
+
+            /* Quad pulling uploads the packed quads, the vertex attribute path four vertices per quad */
+            printResult("mesh", seed, gridSize, lodStep, coords.size(), meshing, std::format(
+                ",\"quads\":{},\"triangles\":{},\"quadBytes\":{},\"vertexBytes\":{}",
+                quadCount, quadCount * 2, quadCount * sizeof(ChunkQuad), quadCount * ChunkMesh::VERTICES_PER_QUAD * sizeof(Voxel)));
+
+            std::vector<Voxel> vertices(quadCount * ChunkMesh::VERTICES_PER_QUAD);
+            const Timing expansion = measure(repetitions, [&]()
+            {
+                size_t vertex = 0;
+                for (const ChunkMesh &mesh : meshes)
+                {
+                    for (const ChunkQuad &quad : mesh.quads)
+                    {
+                        ChunkMesher::expandQuad(quad, std::span<Voxel, ChunkMesh::VERTICES_PER_QUAD>(vertices.data() + vertex, ChunkMesh::VERTICES_PER_QUAD));
+                        vertex += ChunkMesh::VERTICES_PER_QUAD;
+                    }
+                }
+            });
+
+            printResult("expand", seed, gridSize, lodStep, coords.size(), expansion, std::format(
+                ",\"quads\":{},\"nsPerQuad\":{:.3f},\"vertexBytes\":{}",
+                quadCount, quadCount > 0 ? expansion.bestSeconds * 1.0e9 / static_cast<double>(quadCount) : 0.0, vertices.size() * sizeof(Voxel)));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const uint32_t repetitions = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : DEFAULT_REPETITIONS;
+        if (repetitions == 0)
+        {
+            throw std::runtime_error("at least one repetition is needed!");
+        }
+
+        for (const int32_t seed : SEEDS)
+        {
+            for (const uint32_t gridSize : GRID_SIZES)
+            {
+                benchmarkGrid(seed, gridSize, repetitions);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::println(stderr, "{}", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}